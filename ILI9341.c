@@ -10,6 +10,10 @@
  *              Incluye funciones para inicialización, dibujo de píxeles, rotación de pantalla
  *              y llenado de color.
  * 
+ *              El estado de cada pantalla (pines, rotación, última ventana y ráfaga
+ *              pendiente) está en su ILI9341_t; las funciones actúan sobre la
+ *              seleccionada con ILI9341_bind.
+ * 
  * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
  *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025, 
  *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
@@ -17,46 +21,84 @@
  */
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include "nrf_delay.h"
 #include "nrf_gpio.h"
 #include "ILI9341.h"
-#include "nrfx_spi.h"
+#include "LCD_SPI.h"
+#include "LCD_Latency.h"
 #include "LCD_pinout.h"
 
 
-uint8_t gpio_out[3] = {LCD_RESET, LCD_CS, LCD_DC};
+// Rotacion y dimensiones de la pantalla seleccionada, constantes con ILI9341_FIXED_ROTATION
+#ifdef ILI9341_FIXED_ROTATION
+#define DEV_ROTATION ILI9341_FIXED_ROTATION
+#define DEV_WIDTH    ILI9341_FIXED_WIDTH
+#define DEV_HEIGHT   ILI9341_FIXED_HEIGHT
+#else
+#define DEV_ROTATION (dev->rotation)
+#define DEV_WIDTH    (dev->width)
+#define DEV_HEIGHT   (dev->height)
+#endif
+
+// Pantalla de LCD_pinout.h, seleccionada al arrancar
+static ILI9341_t default_device = ILI9341_DEVICE(LCD_CS, LCD_DC, LCD_RESET);
 
-#define SPI_INSTANCE 0	// TODO CREO QUE HAY PONER EL 3
-static const nrfx_spi_t spi = NRFX_SPI_INSTANCE(SPI_INSTANCE);
+// Pantalla seleccionada con ILI9341_bind
+static ILI9341_t *dev = &default_device;
 
 /**
  * @brief Inicializa los pines GPIO necesarios para controlar el ILI9341.
  */
 static void ILI9341_gpio_init(void) {
-    // Configurar pines de control
-    for(uint8_t i = 0; i < 3; i++) {
-        nrf_gpio_pin_dir_set(gpio_out[i], NRF_GPIO_PIN_DIR_OUTPUT);
-        nrf_gpio_pin_write(gpio_out[i], 1);
+    // Configurar pines de control, CS inicialmente alto (deseleccionado)
+    nrf_gpio_pin_dir_set(dev->cs_pin, NRF_GPIO_PIN_DIR_OUTPUT);
+    nrf_gpio_pin_write(dev->cs_pin, 1);
+    nrf_gpio_pin_dir_set(dev->dc_pin, NRF_GPIO_PIN_DIR_OUTPUT);
+    nrf_gpio_pin_write(dev->dc_pin, 1);
+    if (dev->reset_pin != ILI9341_PIN_NOT_USED) {
+        nrf_gpio_pin_dir_set(dev->reset_pin, NRF_GPIO_PIN_DIR_OUTPUT);
+        nrf_gpio_pin_write(dev->reset_pin, 1);
     }
-    
-    // CS inicialmente alto (deseleccionado)
-    nrf_gpio_pin_write(LCD_CS, 1);
 }
 
 /**
- * @brief Inicializa la interfaz SPI para la comunicación con el ILI9341.
+ * @brief Realiza una transacción SPI con el ILI9341 (CS bajo, envío y CS alto).
+ * 
+ * El bus se reserva solo durante la transacción, de forma que el táctil puede
+ * usarlo entre dos transacciones sin afectar al estado del controlador.
+ * 
+ * @param dc Nivel de la línea D/C: 0 para comandos y 1 para datos.
+ * @param data Bytes a enviar.
+ * @param len Número de bytes a enviar.
  */
-static void ILI9341_spi_init(void) {
-    nrfx_spi_config_t spi_config = NRFX_SPI_DEFAULT_CONFIG;
-    spi_config.sck_pin  = SPI_SCK_PIN;
-    spi_config.mosi_pin = SPI_MOSI_PIN;
-    spi_config.miso_pin = SPI_MISO_PIN;
-    spi_config.ss_pin   = NRFX_SPI_PIN_NOT_USED;
-    spi_config.frequency = NRF_SPI_FREQ_4M;
-    spi_config.mode = NRF_SPI_MODE_0;
-    spi_config.bit_order = NRF_SPI_BIT_ORDER_MSB_FIRST;
-    
-    nrfx_spi_init(&spi, &spi_config, NULL, NULL);
+static void ILI9341_transfer(uint8_t dc, const uint8_t *data, uint32_t len) {
+    LCD_SPI_acquire();
+    LCD_SPI_setFrequency(dev->frequency);
+    nrf_gpio_pin_write(dev->dc_pin, dc);
+    nrf_gpio_pin_write(dev->cs_pin, 0);
+
+    LCD_SPI_xfer(data, len, NULL, 0);
+
+    nrf_gpio_pin_write(dev->cs_pin, 1);
+    LCD_SPI_release();
+}
+
+// Envio de pixeles por DMA en curso. Solo puede haber uno, porque tiene el bus reservado
+static struct {
+    uint8_t cs_pin;
+    LCD_SPI_handler_t handler;
+    void *context;
+} async;
+
+/**
+ * @brief Fin de un envio de ILI9341_pushPixelsAsync, desde la interrupcion del SPIM.
+ */
+static void ILI9341_asyncDone(void *context) {
+    nrf_gpio_pin_write(async.cs_pin, 1);
+    LCD_SPI_release();
+    LCD_LATENCY_PIXELS();
+    if (async.handler != NULL) async.handler(async.context);
 }
 
 /**
@@ -65,13 +107,7 @@ static void ILI9341_spi_init(void) {
  * @param cmd Código del comando a enviar.
  */
 static void ILI9341_writeCommand(uint8_t cmd) {
-    nrf_gpio_pin_write(LCD_DC, 0);	// Command mode
-    nrf_gpio_pin_write(LCD_CS, 0);
-    
-    nrfx_spi_xfer_desc_t xfer = NRFX_SPI_XFER_TX(&cmd, 1);
-    nrfx_spi_xfer(&spi, &xfer, 0);
-    
-    nrf_gpio_pin_write(LCD_CS, 1); 
+    ILI9341_transfer(0, &cmd, 1);	// Command mode
 }
 
 /**
@@ -80,13 +116,7 @@ static void ILI9341_writeCommand(uint8_t cmd) {
  * @param data Byte de datos a enviar.
  */
 static void ILI9341_writeData(uint8_t data) {
-    nrf_gpio_pin_write(LCD_DC, 1); // Data mode
-    nrf_gpio_pin_write(LCD_CS, 0);
-    
-    nrfx_spi_xfer_desc_t xfer = NRFX_SPI_XFER_TX(&data, 1);
-    nrfx_spi_xfer(&spi, &xfer, 0);
-    
-    nrf_gpio_pin_write(LCD_CS, 1); 
+    ILI9341_transfer(1, &data, 1); // Data mode
 }
 
 /**
@@ -95,14 +125,8 @@ static void ILI9341_writeData(uint8_t data) {
  * @param data Palabra de 16 bits a enviar.
  */
 static void ILI9341_writeData16(uint16_t data) {
-    nrf_gpio_pin_write(LCD_DC, 1);
-    nrf_gpio_pin_write(LCD_CS, 0);
-    
     uint8_t buffer[2] = {data >> 8, data & 0xFF};
-    nrfx_spi_xfer_desc_t xfer = NRFX_SPI_XFER_TX(buffer, 2);
-    nrfx_spi_xfer(&spi, &xfer, 0);
-    
-    nrf_gpio_pin_write(LCD_CS, 1);
+    ILI9341_transfer(1, buffer, 2);
 }
 
 /**
@@ -144,6 +168,10 @@ static void ILI9341_writeRegister32(uint8_t addr, uint32_t data) {
 /**
  * @brief Establece una ventana de direcciones para el área de dibujo.
  * 
+ * Las columnas y las filas se envían solo si cambian respecto a la última ventana:
+ * RAMWR siempre vuelve a empezar en la esquina de la ventana, por lo que repetirla
+ * no hace falta.
+ * 
  * @param x1 Coordenada X inicial.
  * @param y1 Coordenada Y inicial.
  * @param x2 Coordenada X final.
@@ -152,10 +180,50 @@ static void ILI9341_writeRegister32(uint8_t addr, uint32_t data) {
 static void ILI9341_setAddrWindow(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
 	uint32_t t;
 
-	t = x1 << 16 | x2;
-    ILI9341_writeRegister32(ILI9341_COLADDRSET, t);
-    t = y1 << 16 | y2;
-    ILI9341_writeRegister32(ILI9341_PAGEADDRSET, t);
+    if (!dev->window.columns_valid || dev->window.x0 != x1 || dev->window.x1 != x2) {
+        t = x1 << 16 | x2;
+        ILI9341_writeRegister32(ILI9341_COLADDRSET, t);
+        dev->window.x0 = x1;
+        dev->window.x1 = x2;
+        dev->window.columns_valid = true;
+    }
+    if (!dev->window.pages_valid || dev->window.y0 != y1 || dev->window.y1 != y2) {
+        t = y1 << 16 | y2;
+        ILI9341_writeRegister32(ILI9341_PAGEADDRSET, t);
+        dev->window.y0 = y1;
+        dev->window.y1 = y2;
+        dev->window.pages_valid = true;
+    }
+}
+
+/**
+ * @brief Envía un bloque de bytes de pixel al controlador ILI9341 por SPI.
+ * 
+ * @param data Bytes a enviar (cada pixel ocupa dos bytes, MSB primero).
+ * @param len Número de bytes a enviar.
+ */
+static void ILI9341_writePixelData(const uint8_t *data, uint32_t len) {
+    ILI9341_transfer(1, data, len);
+    LCD_LATENCY_PIXELS();
+}
+
+/**
+ * @brief Envía los pixeles acumulados por el write-combining.
+ * 
+ * La primera vez que se vacía una rafaga se abre la ventana desde el primer pixel
+ * hasta el final de la pantalla y se envía RAMWR; las siguientes veces solo se
+ * envían datos, ya que el controlador mantiene el puntero de escritura.
+ */
+static void ILI9341_wcFlush(void) {
+    if (dev->wc.count == 0) return;
+
+    if (!dev->wc.open) {
+        ILI9341_setAddrWindow(dev->wc.x0, dev->wc.y0, DEV_WIDTH - 1, DEV_HEIGHT - 1);
+        ILI9341_writeCommand(ILI9341_MEMORYWRITE);
+        dev->wc.open = true;
+    }
+    ILI9341_writePixelData(dev->wc.buffer, 2 * dev->wc.count);
+    dev->wc.count = 0;
 }
 
 /**
@@ -167,9 +235,6 @@ static void ILI9341_setAddrWindow(uint16_t x1, uint16_t y1, uint16_t x2, uint16_
 static void ILI9341_flood(uint16_t color, uint32_t len) {
     ILI9341_writeCommand(ILI9341_MEMORYWRITE);
     
-    nrf_gpio_pin_write(LCD_DC, 1);
-    nrf_gpio_pin_write(LCD_CS, 0);
-    
     uint8_t msb = color >> 8;
     uint8_t lsb = color & 0xFF;
     
@@ -179,38 +244,68 @@ static void ILI9341_flood(uint16_t color, uint32_t len) {
         buffer[2*i+1] = lsb;
     }
     
-    // Enviar datos en bloques
+    // Enviar datos en bloques, liberando el bus entre bloques
     while (len >= 32) {
-        nrfx_spi_xfer_desc_t xfer = NRFX_SPI_XFER_TX(buffer, 64);
-        nrfx_spi_xfer(&spi, &xfer, 0);
+        ILI9341_transfer(1, buffer, 64);
         len -= 32;
     }
     
     // Enviar los datos restantes
     if (len > 0) {
-        nrfx_spi_xfer_desc_t xfer = NRFX_SPI_XFER_TX(buffer, 2*len);
-        nrfx_spi_xfer(&spi, &xfer, 0);
+        ILI9341_transfer(1, buffer, 2*len);
     }
-    
-    nrf_gpio_pin_write(LCD_CS, 1);
+    LCD_LATENCY_PIXELS();
+}
+
+/**
+ * @brief Valor de MADCTL para una rotacion.
+ */
+static inline uint8_t ILI9341_madctl(uint8_t dir) {
+	switch(dir) {
+		case 1: //90 degree rotation
+			return ILI9341_MADCTL_MX | ILI9341_MADCTL_MY | ILI9341_MADCTL_MV | ILI9341_MADCTL_BGR;
+		case 2: //180 degree rotation
+			return ILI9341_MADCTL_MX | ILI9341_MADCTL_BGR;
+		case 3: //270 degree rotation
+			return ILI9341_MADCTL_MV | ILI9341_MADCTL_BGR;
+		default: //0 degree rotation, 240x320
+			return ILI9341_MADCTL_MY | ILI9341_MADCTL_BGR;
+	}
 }
 
 /**
  * @brief Realiza un reinicio por software del controlador ILI9341.
  */
 static void ILI9341_reset(void) {
-    nrf_gpio_pin_write(LCD_RESET, 0);
+    if (dev->reset_pin == ILI9341_PIN_NOT_USED) return;
+    nrf_gpio_pin_write(dev->reset_pin, 0);
     nrf_delay_ms(10);
-    nrf_gpio_pin_write(LCD_RESET, 1);
+    nrf_gpio_pin_write(dev->reset_pin, 1);
     nrf_delay_ms(120);
 }
 
+void ILI9341_bind(ILI9341_t *device) {
+    ILI9341_sync();
+    dev = device ? device : &default_device;
+}
+
+ILI9341_t *ILI9341_getDevice(void) {
+    return dev;
+}
+
 void ILI9341_init(void) {
-    ILI9341_spi_init();
+    LCD_SPI_init();
     ILI9341_gpio_init();
     ILI9341_reset();
 
-    rotation_direction = 0;
+    dev->rotation = 0;
+    dev->width = ILI9341_TFTWIDTH;
+    dev->height = ILI9341_TFTHEIGHT;
+    dev->window.columns_valid = false;
+    dev->window.pages_valid = false;
+    dev->wc.count = 0;
+    dev->wc.active = false;
+    dev->wc.open = false;
     ILI9341_writeCommand(ILI9341_SOFTRESET);
     nrf_delay_ms(150);
     
@@ -220,7 +315,9 @@ void ILI9341_init(void) {
     ILI9341_writeRegister8(ILI9341_POWERCONTROL2, 0x10);
     ILI9341_writeRegister16(ILI9341_VCOMCONTROL1, 0x2B2B);
     ILI9341_writeRegister8(ILI9341_VCOMCONTROL2, 0xC0);
-    ILI9341_writeRegister8(ILI9341_MADCTL, ILI9341_MADCTL_MY | ILI9341_MADCTL_BGR);
+    ILI9341_writeRegister8(ILI9341_MADCTL, ILI9341_madctl(DEV_ROTATION));
+    // RGB565. Por SPI el controlador solo admite 16 y 18 bits por pixel, para
+    // enviar mas pixeles por segundo se sube el reloj (ver ILI9341_SPI_FREQUENCY)
     ILI9341_writeRegister8(ILI9341_PIXELFORMAT, 0x55);
     ILI9341_writeRegister16(ILI9341_FRAMECONTROL, 0x001B);
     
@@ -232,38 +329,116 @@ void ILI9341_init(void) {
     ILI9341_writeCommand(ILI9341_DISPLAYON);
     nrf_delay_ms(500);
     
-    ILI9341_setAddrWindow(0, 0, TFTWIDTH - 1, TFTHEIGHT - 1);
+    ILI9341_setAddrWindow(0, 0, DEV_WIDTH - 1, DEV_HEIGHT - 1);
+}
+
+#ifndef ILI9341_FIXED_ROTATION
+uint8_t ILI9341_getRotation(void) {
+    return dev->rotation;
 }
 
+int16_t ILI9341_width(void) {
+    return dev->width;
+}
+
+int16_t ILI9341_height(void) {
+    return dev->height;
+}
+#endif
 
 void ILI9341_drawPixel(int16_t x, int16_t y, uint16_t color) {
-	if(x < 0 || y < 0 || x >= TFTWIDTH || y >= TFTHEIGHT) return;
+	if(x < 0 || y < 0 || x >= DEV_WIDTH || y >= DEV_HEIGHT) return;
+
+    // Si el pixel no continua la rafaga actual se empieza una nueva
+    if (!dev->wc.active || x != dev->wc.next_x || y != dev->wc.next_y) {
+        ILI9341_sync();
+        dev->wc.active = true;
+        dev->wc.x0 = dev->wc.next_x = x;
+        dev->wc.y0 = dev->wc.next_y = y;
+    }
+
+    dev->wc.buffer[2 * dev->wc.count] = color >> 8;
+    dev->wc.buffer[2 * dev->wc.count + 1] = color & 0xFF;
+    dev->wc.count++;
+
+    // Avanzar el puntero de GRAM igual que lo hace el controlador
+    if (++dev->wc.next_x >= DEV_WIDTH) {
+        dev->wc.next_x = dev->wc.x0;
+        dev->wc.next_y++;
+    }
+
+    if (dev->wc.count == ILI9341_WC_PIXELS) {
+        ILI9341_wcFlush();
+    }
+}
+
+void ILI9341_sync(void) {
+    ILI9341_wcFlush();
+    dev->wc.active = false;
+    dev->wc.open = false;
+}
+
+void ILI9341_setWindow(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    ILI9341_sync();
+    ILI9341_setAddrWindow(x0, y0, x1, y1);
+    ILI9341_writeCommand(ILI9341_MEMORYWRITE);
+}
+
+void ILI9341_pushPixels(const uint8_t *data, uint32_t len) {
+    ILI9341_writePixelData(data, len);
+}
+
+void ILI9341_pushPixelsAsync(const uint8_t *data, uint32_t len, LCD_SPI_handler_t handler, void *context) {
+    // Desde el aviso del envio anterior tambien se puede reservar sin comprobar antes
+    // LCD_SPI_isBusy(): ILI9341_asyncDone acaba de liberar el bus (y de atender lo
+    // aplazado, que lo vuelve a liberar), el programa principal no puede tomarlo sin
+    // que vuelva la interrupcion y una interrupcion mas prioritaria lo libera antes
+    // de devolver el control
+    LCD_SPI_acquire();
+    LCD_SPI_setFrequency(dev->frequency);
+    nrf_gpio_pin_write(dev->dc_pin, 1);
+    nrf_gpio_pin_write(dev->cs_pin, 0);
 
-    ILI9341_setAddrWindow(x, y, x, y);
-	ILI9341_writeRegister16(ILI9341_MEMORYWRITE, color);
+    async.cs_pin = dev->cs_pin;
+    async.handler = handler;
+    async.context = context;
+    LCD_SPI_xferAsync(data, len, ILI9341_asyncDone, NULL);
 }
 
 void ILI9341_setRotation(uint8_t dir) {
-	uint8_t val;
-	rotation_direction = dir;
-	switch(dir) {
-		case 1: //90 degree rotation
-			val = ILI9341_MADCTL_MX | ILI9341_MADCTL_MY | ILI9341_MADCTL_MV | ILI9341_MADCTL_BGR;
-			break;
-		case 2: //180 degree rotation
-			val = ILI9341_MADCTL_MX | ILI9341_MADCTL_BGR;
-			break;
-		case 3: //270 degree rotation
-			val = ILI9341_MADCTL_MV | ILI9341_MADCTL_BGR;
-			break;
-		default: //0 degree rotation, 240x320
-			val = ILI9341_MADCTL_MY | ILI9341_MADCTL_BGR;
-	}
-	ILI9341_writeRegister8(ILI9341_MADCTL, val);
-    ILI9341_setAddrWindow(0, 0, TFTWIDTH - 1, TFTHEIGHT - 1);
+#ifdef ILI9341_FIXED_ROTATION
+	(void)dir;
+#else
+	ILI9341_sync();
+	dir &= 3;
+	dev->rotation = dir;
+	dev->width = (dir % 2 == 0) ? ILI9341_TFTWIDTH : ILI9341_TFTHEIGHT;
+	dev->height = (dir % 2 == 0) ? ILI9341_TFTHEIGHT : ILI9341_TFTWIDTH;
+	ILI9341_writeRegister8(ILI9341_MADCTL, ILI9341_madctl(dir));
+	// Con MV cambiado la ventana guardada ya no corresponde a la del controlador
+	dev->window.columns_valid = false;
+	dev->window.pages_valid = false;
+    ILI9341_setAddrWindow(0, 0, DEV_WIDTH - 1, DEV_HEIGHT - 1);
+#endif
 }
 
 void ILI9341_fillScreen(uint16_t color) {	
-	ILI9341_setAddrWindow(0, 0, TFTWIDTH - 1, TFTHEIGHT - 1);
-	ILI9341_flood(color, TFTWIDTH * TFTHEIGHT);
+	ILI9341_sync();
+	ILI9341_setAddrWindow(0, 0, DEV_WIDTH - 1, DEV_HEIGHT - 1);
+	ILI9341_flood(color, (uint32_t)DEV_WIDTH * DEV_HEIGHT);
+}
+
+void ILI9341_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 >= DEV_WIDTH) x1 = DEV_WIDTH - 1;
+    if (y1 >= DEV_HEIGHT) y1 = DEV_HEIGHT - 1;
+    if (x > x1 || y > y1) return;
+
+    ILI9341_sync();
+    ILI9341_setAddrWindow(x, y, x1, y1);
+    ILI9341_flood(color, (uint32_t)(x1 - x + 1) * (y1 - y + 1));
 }
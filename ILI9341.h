@@ -20,10 +20,34 @@
 #define _ILI9341_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "LCD_SPI.h"
 
-// Dimensiones de la pantalla
-#define TFTHEIGHT ((rotation_direction % 2 == 0) ? 320 : 240)
-#define TFTWIDTH  ((rotation_direction % 2 == 0) ? 240 : 320)
+// Dimensiones del panel en la rotacion 0
+#define ILI9341_TFTWIDTH  240
+#define ILI9341_TFTHEIGHT 320
+
+// Rotacion fija: definiendo ILI9341_FIXED_ROTATION (0-3) al compilar, por ejemplo con
+// -DILI9341_FIXED_ROTATION=1, todas las pantallas quedan en esa rotacion y las
+// dimensiones, el recorte y MADCTL pasan a ser constantes. ILI9341_setRotation no
+// hace nada. Pensado para productos con una sola orientacion.
+#ifdef ILI9341_FIXED_ROTATION
+#if ILI9341_FIXED_ROTATION < 0 || ILI9341_FIXED_ROTATION > 3
+#error "ILI9341_FIXED_ROTATION debe estar entre 0 y 3"
+#endif
+#define ILI9341_FIXED_WIDTH  ((ILI9341_FIXED_ROTATION % 2 == 0) ? ILI9341_TFTWIDTH : ILI9341_TFTHEIGHT)
+#define ILI9341_FIXED_HEIGHT ((ILI9341_FIXED_ROTATION % 2 == 0) ? ILI9341_TFTHEIGHT : ILI9341_TFTWIDTH)
+#endif
+
+// Pin no conectado (por ejemplo, RESET compartido entre dos pantallas)
+#define ILI9341_PIN_NOT_USED 0xFF
+
+// Reloj SPI por defecto: 8 MHz es el maximo de SPIM0, el que usa LCD_SPI (solo SPIM3
+// llega a 32 MHz), y cabe en el ciclo de escritura de 100 ns (10 MHz) del ILI9341
+#define ILI9341_SPI_FREQUENCY LCD_SPI_FREQ_8M
+
+// Write-combining de ILI9341_drawPixel
+#define ILI9341_WC_PIXELS 32
 
 // Registros del módulo
 #define ILI9341_NOOP               0x00
@@ -58,25 +82,160 @@
 #define ILI9341_MADCTL_BGR 0x08
 #define ILI9341_MADCTL_MH  0x04
 
-static int rotation_direction = 0;
 /**
- * @brief Inicializa el controlador del ILI9341
+ * @brief Contexto de una pantalla.
+ * 
+ * Los pines y la frecuencia se rellenan con ILI9341_DEVICE antes de llamar a
+ * ILI9341_bind (la frecuencia puede cambiarse después); el resto de campos
+ * son internos. Todas las pantallas comparten el bus de LCD_SPI, cada una con
+ * su CS y su D/C.
+ */
+typedef struct {
+    // Pines
+    uint8_t cs_pin;
+    uint8_t dc_pin;
+    uint8_t reset_pin;              // ILI9341_PIN_NOT_USED si no se controla
+    LCD_SPI_frequency_t frequency;  // Reloj SPI de las transacciones con esta pantalla
+
+    // Rotacion y dimensiones en esa rotacion
+    uint8_t rotation;
+    int16_t width;
+    int16_t height;
+
+    // Ultima ventana enviada (CASET y PASET), para no repetirla
+    struct {
+        uint16_t x0, x1;
+        uint16_t y0, y1;
+        bool columns_valid;
+        bool pages_valid;
+    } window;
+
+    // Rafaga de RAMWR pendiente de ILI9341_drawPixel. Mientras los pixeles lleguen
+    // en el orden en el que avanza el puntero de la GRAM se acumulan en `buffer`
+    // y se envian en bloque sin reabrir la ventana.
+    struct {
+        uint8_t buffer[2 * ILI9341_WC_PIXELS];  // Pixeles pendientes (MSB primero)
+        uint16_t count;                         // Numero de pixeles en el buffer
+        bool active;                            // Hay una rafaga en curso
+        bool open;                              // Ventana y RAMWR ya enviados
+        int16_t x0, y0;                         // Esquina superior izquierda de la ventana
+        int16_t next_x, next_y;                 // Siguiente posicion del puntero de GRAM
+    } wc;
+} ILI9341_t;
+
+// Inicializador de un ILI9341_t con sus pines
+#define ILI9341_DEVICE(cs, dc, reset) { .cs_pin = (cs), .dc_pin = (dc), .reset_pin = (reset), \
+                                       .frequency = ILI9341_SPI_FREQUENCY }
+
+/**
+ * @brief Selecciona la pantalla sobre la que actúan el resto de funciones del módulo.
+ * 
+ * Al arrancar está seleccionada la pantalla de LCD_pinout.h. Antes de cambiar se
+ * envían los píxeles pendientes de la pantalla anterior.
+ * 
+ * @param dev Pantalla a seleccionar, o NULL para volver a la de LCD_pinout.h.
+ */
+void ILI9341_bind(ILI9341_t *dev);
+
+/**
+ * @brief Devuelve la pantalla seleccionada.
+ */
+ILI9341_t *ILI9341_getDevice(void);
+
+/**
+ * @brief Inicializa el controlador del ILI9341 de la pantalla seleccionada.
  * @note Esta funcion debe ser llamada antes de cualquier otra de este módulo.
  */
 void ILI9341_init(void);
 
+#ifdef ILI9341_FIXED_ROTATION
+
+#define ILI9341_getRotation() ((uint8_t)ILI9341_FIXED_ROTATION)
+#define ILI9341_width()       ((int16_t)ILI9341_FIXED_WIDTH)
+#define ILI9341_height()      ((int16_t)ILI9341_FIXED_HEIGHT)
+
+#else
+
+/**
+ * @brief Devuelve la rotación de la pantalla seleccionada [0-3].
+ */
+uint8_t ILI9341_getRotation(void);
+
+/**
+ * @brief Ancho en píxeles de la pantalla seleccionada en su rotación actual.
+ */
+int16_t ILI9341_width(void);
+
+/**
+ * @brief Alto en píxeles de la pantalla seleccionada en su rotación actual.
+ */
+int16_t ILI9341_height(void);
+
+#endif
+
 /**
  * @brief Dibuja un píxel en la pantalla LCD.
  * 
+ * Los píxeles que continúan la posición del puntero de escritura de la GRAM
+ * (de izquierda a derecha y de arriba a abajo) se acumulan en una misma ráfaga
+ * de RAMWR. La ráfaga se envía al llenarse el buffer, al dibujar un píxel no
+ * consecutivo o al llamar a ILI9341_sync().
+ * 
  * @param x Coordenada X del píxel.
  * @param y Coordenada Y del píxel.
  * @param color Color del píxel.
  */
 void ILI9341_drawPixel(int16_t x, int16_t y, uint16_t color);
 
+/**
+ * @brief Envía a la pantalla los píxeles pendientes de ILI9341_drawPixel y
+ * cierra la ráfaga de escritura actual.
+ */
+void ILI9341_sync(void);
+
+/**
+ * @brief Abre una ventana de escritura en la GRAM y envía RAMWR.
+ * 
+ * Los píxeles enviados después con ILI9341_pushPixels() rellenan la ventana de
+ * izquierda a derecha y de arriba a abajo. La ventana debe estar dentro de la
+ * pantalla.
+ * 
+ * @param x0 Coordenada X de la esquina superior izquierda.
+ * @param y0 Coordenada Y de la esquina superior izquierda.
+ * @param x1 Coordenada X de la esquina inferior derecha (incluida).
+ * @param y1 Coordenada Y de la esquina inferior derecha (incluida).
+ */
+void ILI9341_setWindow(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+/**
+ * @brief Envía píxeles a la ventana abierta con ILI9341_setWindow().
+ * 
+ * @param data Píxeles RGB565 con el byte más significativo primero, tal y como
+ *             se envían por SPI.
+ * @param len Número de bytes a enviar (dos por píxel).
+ */
+void ILI9341_pushPixels(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Empieza a enviar píxeles por DMA a la ventana abierta y vuelve sin esperar.
+ * 
+ * El bus queda reservado hasta que termina el envío, por lo que cualquier otra
+ * transacción espera a que acabe. Al terminar se llama a `handler` desde la
+ * interrupción del SPIM; desde ahí se puede lanzar el siguiente envío. Es la única
+ * interrupción desde la que se puede llamar, porque el bus se acaba de liberar a
+ * esa misma prioridad y la reserva no tiene que esperar.
+ * 
+ * @param data Píxeles como en ILI9341_pushPixels(). Deben estar en RAM y no
+ *             cambiar hasta el aviso.
+ * @param len Número de bytes a enviar (dos por píxel).
+ * @param handler Función a la que se avisa al terminar (puede ser NULL).
+ * @param context Parámetro para `handler`.
+ */
+void ILI9341_pushPixelsAsync(const uint8_t *data, uint32_t len, LCD_SPI_handler_t handler, void *context);
+
 /**
  * @brief Establece la rotacion de la pantalla cambiando el modo en el que
- * se escribe en el buffer de la pantalla. 
+ * se escribe en el buffer de la pantalla. Con ILI9341_FIXED_ROTATION no hace nada.
  * @param dir Nueva direccion en la que se escriben los datos [0-3]
  */
 void ILI9341_setRotation(uint8_t dir);
@@ -86,4 +245,17 @@ void ILI9341_setRotation(uint8_t dir);
  */
 void ILI9341_fillScreen(uint16_t color);
 
+/**
+ * @brief Rellena un rectángulo con una sola ventana y un único RAMWR.
+ * 
+ * La parte del rectángulo que queda fuera de la pantalla se recorta.
+ * 
+ * @param x Coordenada X de la esquina superior izquierda.
+ * @param y Coordenada Y de la esquina superior izquierda.
+ * @param w Ancho en píxeles.
+ * @param h Alto en píxeles.
+ * @param color Color de relleno.
+ */
+void ILI9341_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
 #endif
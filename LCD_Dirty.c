@@ -0,0 +1,136 @@
+/**
+ * @file        LCD_Dirty.c
+ * @brief       Implementación del gestor de zonas modificadas (rectángulos sucios).
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Al añadir un rectángulo se busca el ya marcado con el que la caja
+ *              envolvente añade menos píxeles. Si esos píxeles cuestan menos que una
+ *              ventana se unen y la caja se vuelve a añadir, por si ahora también
+ *              conviene unirla con otro. Un rectángulo contenido en otro se une
+ *              siempre, porque no añade nada. Si no hay sitio se une la pareja más
+ *              barata, sea el nuevo con uno de los marcados o dos de los marcados.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Dirty.h
+ */
+#include "LCD_Dirty.h"
+
+static inline uint32_t LCD_Dirty_area(const LCD_Dirty_rect_t *r) {
+    return (uint32_t)(r->x1 - r->x0 + 1) * (uint32_t)(r->y1 - r->y0 + 1);
+}
+
+static inline void LCD_Dirty_union(const LCD_Dirty_rect_t *a, const LCD_Dirty_rect_t *b, LCD_Dirty_rect_t *out) {
+    out->x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+    out->y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+    out->x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+    out->y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+}
+
+/**
+ * @brief Pixeles que la union `u` de `a` y `b` envia de mas (negativo si se solapan).
+ */
+static inline int32_t LCD_Dirty_extra(const LCD_Dirty_rect_t *a, const LCD_Dirty_rect_t *b, const LCD_Dirty_rect_t *u) {
+    return (int32_t)LCD_Dirty_area(u) - (int32_t)LCD_Dirty_area(a) - (int32_t)LCD_Dirty_area(b);
+}
+
+void LCD_Dirty_init(LCD_Dirty_t *dirty, int16_t width, int16_t height, uint16_t window_cost) {
+    dirty->count = 0;
+    dirty->width = width;
+    dirty->height = height;
+    dirty->window_cost = window_cost;
+}
+
+void LCD_Dirty_add(LCD_Dirty_t *dirty, int16_t x, int16_t y, int16_t w, int16_t h) {
+    LCD_Dirty_rect_t r = { x, y, x + w - 1, y + h - 1 };
+
+    // Recortar
+    if (r.x0 < 0) r.x0 = 0;
+    if (r.y0 < 0) r.y0 = 0;
+    if (r.x1 >= dirty->width) r.x1 = dirty->width - 1;
+    if (r.y1 >= dirty->height) r.y1 = dirty->height - 1;
+    if (r.x0 > r.x1 || r.y0 > r.y1) return;
+
+    // Ya cubierto por un rectangulo: no hay nada que unir
+    for (uint8_t i = 0; i < dirty->count; i++) {
+        const LCD_Dirty_rect_t *c = &dirty->rects[i];
+        if (r.x0 >= c->x0 && r.y0 >= c->y0 && r.x1 <= c->x1 && r.y1 <= c->y1) return;
+    }
+
+    for (;;) {
+        // Rectangulo con el que la union añade menos pixeles
+        int8_t best = -1;
+        int32_t best_extra = 0;
+        LCD_Dirty_rect_t best_union = r;
+        for (uint8_t i = 0; i < dirty->count; i++) {
+            LCD_Dirty_rect_t u;
+            LCD_Dirty_union(&dirty->rects[i], &r, &u);
+            int32_t extra = LCD_Dirty_extra(&dirty->rects[i], &r, &u);
+            if (best < 0 || extra < best_extra) {
+                best = i;
+                best_extra = extra;
+                best_union = u;
+            }
+        }
+
+        if (best < 0 || best_extra > (int32_t)dirty->window_cost) {
+            if (dirty->count < LCD_DIRTY_MAX_RECTS) {
+                dirty->rects[dirty->count++] = r;
+                return;
+            }
+
+            // Lleno: puede salir mas barato unir dos de los que ya estan y guardar r aparte
+            int8_t pi = -1, pj = -1;
+            int32_t pair_extra = best_extra;
+            LCD_Dirty_rect_t pair_union;
+            for (uint8_t i = 0; i < dirty->count; i++) {
+                for (uint8_t j = i + 1; j < dirty->count; j++) {
+                    LCD_Dirty_rect_t u;
+                    LCD_Dirty_union(&dirty->rects[i], &dirty->rects[j], &u);
+                    int32_t extra = LCD_Dirty_extra(&dirty->rects[i], &dirty->rects[j], &u);
+                    if (extra < pair_extra) {
+                        pi = i;
+                        pj = j;
+                        pair_extra = extra;
+                        pair_union = u;
+                    }
+                }
+            }
+            if (pi >= 0) {
+                dirty->rects[pi] = r;
+                dirty->rects[pj] = dirty->rects[--dirty->count];
+                r = pair_union;
+                continue;
+            }
+        }
+
+        // Unir: se quita el rectangulo y se vuelve a probar con la caja
+        dirty->rects[best] = dirty->rects[--dirty->count];
+        r = best_union;
+    }
+}
+
+bool LCD_Dirty_pop(LCD_Dirty_t *dirty, LCD_Dirty_rect_t *rect) {
+    if (dirty->count == 0) return false;
+    *rect = dirty->rects[--dirty->count];
+    return true;
+}
+
+void LCD_Dirty_clear(LCD_Dirty_t *dirty) {
+    dirty->count = 0;
+}
+
+bool LCD_Dirty_isEmpty(const LCD_Dirty_t *dirty) {
+    return dirty->count == 0;
+}
+
+uint32_t LCD_Dirty_cost(const LCD_Dirty_t *dirty) {
+    uint32_t cost = 0;
+    for (uint8_t i = 0; i < dirty->count; i++) {
+        cost += LCD_Dirty_area(&dirty->rects[i]) + dirty->window_cost;
+    }
+    return cost;
+}
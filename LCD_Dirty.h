@@ -0,0 +1,96 @@
+/**
+ * @file        LCD_Dirty.h
+ * @brief       Cabeceras del gestor de zonas modificadas (rectángulos sucios).
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Acumula los rectángulos que hay que volver a enviar o redibujar y los
+ *              agrupa para minimizar el coste de enviarlos. Cada ventana del ILI9341
+ *              cuesta una configuración fija (CASET, PASET y RAMWR, cada uno con su
+ *              transferencia SPI) además de sus píxeles, así que dos rectángulos se
+ *              unen en su caja envolvente cuando los píxeles de más que añade la caja
+ *              cuestan menos que una ventana.
+ *
+ *              Lo usa LCD_Framebuffer para decidir qué vuelca, y también se puede usar
+ *              solo con LCD_GFX: los widgets marcan su zona al cambiar y la aplicación
+ *              redibuja cada rectángulo devuelto por LCD_Dirty_pop.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Dirty.c, LCD_Framebuffer.h
+ */
+
+#ifndef LCD_DIRTY_H
+#define LCD_DIRTY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Rectangulos como maximo; al llenarse se une la pareja mas barata
+#define LCD_DIRTY_MAX_RECTS 8
+
+// Coste de abrir una ventana en el ILI9341, en pixeles equivalentes. Son 11 bytes de
+// comandos y parametros repartidos en 6 transferencias SPI, cuyo coste fijo domina
+#define LCD_DIRTY_WINDOW_COST 32
+
+/**
+ * @brief Rectángulo con ambas esquinas incluidas.
+ */
+typedef struct {
+    int16_t x0, y0, x1, y1;
+} LCD_Dirty_rect_t;
+
+/**
+ * @brief Conjunto de zonas modificadas.
+ *
+ * Los campos son internos, se manejan con las funciones LCD_Dirty_*.
+ */
+typedef struct {
+    LCD_Dirty_rect_t rects[LCD_DIRTY_MAX_RECTS];
+    uint8_t count;
+    int16_t width, height;          // Los rectangulos se recortan a [0, width) x [0, height)
+    uint16_t window_cost;           // Coste de una ventana en pixeles
+} LCD_Dirty_t;
+
+/**
+ * @brief Inicializa un conjunto vacío.
+ *
+ * @param dirty Conjunto a inicializar.
+ * @param width Ancho de la zona en la que se recortan los rectángulos.
+ * @param height Alto de la zona en la que se recortan los rectángulos.
+ * @param window_cost Coste de una ventana en píxeles (normalmente LCD_DIRTY_WINDOW_COST).
+ */
+void LCD_Dirty_init(LCD_Dirty_t *dirty, int16_t width, int16_t height, uint16_t window_cost);
+
+/**
+ * @brief Marca un rectángulo de `w` x `h` píxeles como modificado.
+ *
+ * Se une a los rectángulos ya marcados con los que sale más barato enviarlo junto.
+ */
+void LCD_Dirty_add(LCD_Dirty_t *dirty, int16_t x, int16_t y, int16_t w, int16_t h);
+
+/**
+ * @brief Saca el siguiente rectángulo del conjunto.
+ *
+ * @return false si no queda ninguno.
+ */
+bool LCD_Dirty_pop(LCD_Dirty_t *dirty, LCD_Dirty_rect_t *rect);
+
+/**
+ * @brief Vacía el conjunto.
+ */
+void LCD_Dirty_clear(LCD_Dirty_t *dirty);
+
+/**
+ * @brief Indica si no hay nada marcado.
+ */
+bool LCD_Dirty_isEmpty(const LCD_Dirty_t *dirty);
+
+/**
+ * @brief Coste estimado de enviar el conjunto: píxeles más una ventana por rectángulo.
+ */
+uint32_t LCD_Dirty_cost(const LCD_Dirty_t *dirty);
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file        LCD_Expand.c
+ * @brief       Implementación del núcleo de expansión de imágenes de 1 bit por píxel a RGB565.
+ * 
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ * 
+ * @details     Cada palabra de 32 bits de salida contiene dos píxeles. En memoria
+ *              (little-endian) el píxel de la izquierda ocupa los dos bytes bajos y
+ *              cada píxel tiene los bytes intercambiados, de forma que el orden de
+ *              bytes coincide con el que espera el ILI9341.
+ * 
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025, 
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Expand.h
+ */
+#include <stdbool.h>
+#include "LCD_Expand.h"
+
+// Color RGB565 con el MSB en el byte bajo
+#define SWAP16(c) ((uint32_t)((((c) >> 8) & 0xFF) | (((c) & 0xFF) << 8)))
+
+#if defined(__ARM_FEATURE_SIMD32)
+#include "nrf.h"
+
+/**
+ * @brief Mascaras por pareja de bits (bit 1 = pixel izquierdo, bit 0 = pixel derecho).
+ * 
+ * __USUB8(mascara, 0x01010101) pone a 1 los flags GE de los bytes a 0xFF y __SEL
+ * toma esos bytes de `fg` y el resto de `bg`, sin tabla que dependa de los colores.
+ */
+static const uint32_t pair_mask[4] = { 0x00000000, 0xFFFF0000, 0x0000FFFF, 0xFFFFFFFF };
+
+void LCD_Expand_1bpp(uint32_t *dst, const uint8_t *bits, uint16_t w, uint16_t fg, uint16_t bg) {
+    uint32_t fg2 = SWAP16(fg) * 0x00010001;
+    uint32_t bg2 = SWAP16(bg) * 0x00010001;
+
+    for (uint16_t n = (w + 7) / 8; n > 0; n--) {
+        uint8_t b = *bits++;
+        __USUB8(pair_mask[b >> 6], 0x01010101);
+        dst[0] = __SEL(fg2, bg2);
+        __USUB8(pair_mask[(b >> 4) & 0x3], 0x01010101);
+        dst[1] = __SEL(fg2, bg2);
+        __USUB8(pair_mask[(b >> 2) & 0x3], 0x01010101);
+        dst[2] = __SEL(fg2, bg2);
+        __USUB8(pair_mask[b & 0x3], 0x01010101);
+        dst[3] = __SEL(fg2, bg2);
+        dst += 4;
+    }
+}
+
+#else
+
+/**
+ * @brief Tabla de 4 pixeles (dos palabras) por cada valor de un nibble, para la
+ * pareja de colores `lut_fg`/`lut_bg`.
+ */
+static uint32_t lut[16][2];
+static uint16_t lut_fg, lut_bg;
+static bool lut_valid = false;
+
+/**
+ * @brief Recalcula la tabla si los colores son distintos de los de la ultima llamada.
+ */
+static void LCD_Expand_buildLut(uint16_t fg, uint16_t bg) {
+    if (lut_valid && fg == lut_fg && bg == lut_bg) return;
+
+    uint32_t f = SWAP16(fg), b = SWAP16(bg);
+    for (uint8_t n = 0; n < 16; n++) {
+        lut[n][0] = ((n & 0x8) ? f : b) | ((n & 0x4) ? f : b) << 16;
+        lut[n][1] = ((n & 0x2) ? f : b) | ((n & 0x1) ? f : b) << 16;
+    }
+    lut_fg = fg;
+    lut_bg = bg;
+    lut_valid = true;
+}
+
+void LCD_Expand_1bpp(uint32_t *dst, const uint8_t *bits, uint16_t w, uint16_t fg, uint16_t bg) {
+    LCD_Expand_buildLut(fg, bg);
+
+    for (uint16_t n = (w + 7) / 8; n > 0; n--) {
+        uint8_t b = *bits++;
+        const uint32_t *hi = lut[b >> 4];
+        const uint32_t *lo = lut[b & 0xF];
+        dst[0] = hi[0];
+        dst[1] = hi[1];
+        dst[2] = lo[0];
+        dst[3] = lo[1];
+        dst += 4;
+    }
+}
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ * @file        LCD_Expand.h
+ * @brief       Cabeceras del núcleo de expansión de imágenes de 1 bit por píxel a RGB565.
+ * 
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ * 
+ * @details     Convierte filas de bits (fuente, bitmaps monocromo, iconos) en píxeles
+ *              RGB565 de dos colores listos para enviarse por SPI. Cada byte de bits
+ *              se convierte en 8 píxeles con cuatro escrituras de 32 bits a partir de
+ *              una tabla por pareja de colores, que solo se recalcula cuando cambian
+ *              los colores. En Cortex-M4 se usan las instrucciones SIMD __USUB8/__SEL
+ *              y no hace falta tabla por colores.
+ * 
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025, 
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Expand.c
+ */
+
+#ifndef LCD_EXPAND_H
+#define LCD_EXPAND_H
+
+#include <stdint.h>
+
+/**
+ * @brief Convierte una fila de bits en píxeles RGB565 de dos colores.
+ * 
+ * @param dst Buffer de salida alineado a 4 bytes. Los píxeles quedan con el byte más
+ *            significativo primero, tal y como se envían por SPI. Debe tener espacio
+ *            para `w` redondeado al siguiente múltiplo de 8 píxeles.
+ * @param bits Fila de bits, MSB a la izquierda. Un bit a 1 usa `fg` y a 0 usa `bg`.
+ * @param w Número de píxeles de la fila.
+ * @param fg Color de los bits a 1.
+ * @param bg Color de los bits a 0.
+ */
+void LCD_Expand_1bpp(uint32_t *dst, const uint8_t *bits, uint16_t w, uint16_t fg, uint16_t bg);
+
+#endif
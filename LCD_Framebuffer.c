@@ -0,0 +1,386 @@
+/**
+ * @file        LCD_Framebuffer.c
+ * @brief       Implementación del framebuffer en RAM con color indexado por paleta.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     La paleta se guarda con los bytes ya intercambiados, de forma que la
+ *              traducción de una fila es una lectura de tabla por píxel y las
+ *              escrituras de 32 bits del buffer de salida (dos píxeles) quedan en el
+ *              orden en el que se envían por SPI. Las zonas modificadas se llevan con
+ *              LCD_Dirty, que decide cuántas ventanas se abren en el volcado.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Framebuffer.h
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "LCD_Framebuffer.h"
+#include "ILI9341.h"
+#include "LCD_Expand.h"
+#include "LCD_Pipeline.h"
+#include "bitmaps.h"
+
+// Color RGB565 con el MSB en el byte bajo
+#define SWAP16(c) ((uint16_t)((((c) >> 8) & 0xFF) | (((c) & 0xFF) << 8)))
+
+// Palabra de 1 bpp leida en little-endian a orden de pixeles (MSB a la izquierda) y viceversa.
+// En Cortex-M es una sola instruccion REV
+#define BSWAP32(v) __builtin_bswap32(v)
+
+// Las filas se traducen en los buffers de LCD_Pipeline. En 1 bpp se expanden desde el
+// byte que contiene la primera columna, hasta 7 pixeles antes
+#if LCD_PIPELINE_BUFFER_SIZE < 2 * (LCD_FRAMEBUFFER_MAX_WIDTH + 8)
+#error "LCD_PIPELINE_BUFFER_SIZE no admite una fila de LCD_FRAMEBUFFER_MAX_WIDTH"
+#endif
+
+/**
+ * @brief Vacia la caja de los pixeles sueltos.
+ */
+static inline void LCD_Framebuffer_clearPixels(LCD_Framebuffer_t *fb) {
+    fb->pixels.x0 = fb->pixels.y0 = INT16_MAX;
+    fb->pixels.x1 = fb->pixels.y1 = -1;
+}
+
+/**
+ * @brief Añade un rectangulo, con ambas esquinas incluidas, a las zonas modificadas.
+ *
+ * Antes se añaden los pixeles sueltos: una primitiva nueva cierra la anterior.
+ */
+static inline void LCD_Framebuffer_markDirty(LCD_Framebuffer_t *fb, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    LCD_Framebuffer_commit(fb);
+    LCD_Dirty_add(&fb->dirty, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+}
+
+/**
+ * @brief Escribe un pixel sin comprobar limites ni marcar la zona modificada.
+ */
+static inline void LCD_Framebuffer_put(LCD_Framebuffer_t *fb, int16_t x, int16_t y, uint8_t index) {
+    uint8_t *row = fb->data + (uint32_t)y * fb->stride;
+    if (fb->format == LCD_FRAMEBUFFER_MONO) {
+        if (index & 1) row[x >> 3] |= 0x80 >> (x & 0x07);
+        else row[x >> 3] &= ~(0x80 >> (x & 0x07));
+    }
+    else if (fb->format == LCD_FRAMEBUFFER_I8) {
+        row[x] = index;
+    }
+    else if (x & 1) {
+        row[x >> 1] = (row[x >> 1] & 0xF0) | (index & 0x0F);
+    }
+    else {
+        row[x >> 1] = (row[x >> 1] & 0x0F) | (index << 4);
+    }
+}
+
+/**
+ * @brief Rellena los pixeles [x0, x1] de una fila sin comprobar limites.
+ */
+static void LCD_Framebuffer_fillSpan(LCD_Framebuffer_t *fb, uint8_t *row, int16_t x0, int16_t x1, uint8_t index) {
+    if (fb->format == LCD_FRAMEBUFFER_MONO) {
+        // Palabra a palabra, con mascaras en los extremos
+        uint32_t *word = (uint32_t *)row + (x0 >> 5);
+        uint32_t *last = (uint32_t *)row + (x1 >> 5);
+        uint32_t head = 0xFFFFFFFFu >> (x0 & 31);
+        uint32_t tail = 0xFFFFFFFFu << (31 - (x1 & 31));
+        uint32_t value = (index & 1) ? 0xFFFFFFFFu : 0;
+
+        if (word == last) head &= tail;
+        head = BSWAP32(head);
+        *word = (*word & ~head) | (value & head);
+        if (word == last) return;
+        for (word++; word < last; word++) {
+            *word = value;
+        }
+        tail = BSWAP32(tail);
+        *last = (*last & ~tail) | (value & tail);
+        return;
+    }
+    if (fb->format == LCD_FRAMEBUFFER_I8) {
+        memset(row + x0, index, x1 - x0 + 1);
+        return;
+    }
+
+    index &= 0x0F;
+    if (x0 & 1) {
+        row[x0 >> 1] = (row[x0 >> 1] & 0xF0) | index;
+        x0++;
+    }
+    if (x0 > x1) return;
+    if (!(x1 & 1)) {
+        row[x1 >> 1] = (row[x1 >> 1] & 0x0F) | (index << 4);
+        x1--;
+    }
+    if (x0 < x1) {
+        memset(row + (x0 >> 1), index * 0x11, (x1 - x0 + 1) / 2);
+    }
+}
+
+void LCD_Framebuffer_init(LCD_Framebuffer_t *fb, uint8_t *buffer, LCD_Framebuffer_format_t format,
+                          int16_t x, int16_t y, int16_t width, int16_t height) {
+    if (width > LCD_FRAMEBUFFER_MAX_WIDTH) width = LCD_FRAMEBUFFER_MAX_WIDTH;
+
+    fb->data = buffer;
+    fb->format = format;
+    fb->stride = LCD_FRAMEBUFFER_STRIDE(format, width);
+    fb->width = width;
+    fb->height = height;
+    fb->x = x;
+    fb->y = y;
+    fb->colors = (format == LCD_FRAMEBUFFER_MONO) ? 2 : (format == LCD_FRAMEBUFFER_I4) ? 16 : 256;
+    memset(fb->palette, 0, sizeof(fb->palette));
+    memset(fb->data, 0, LCD_FRAMEBUFFER_SIZE(format, width, height));
+    LCD_Dirty_init(&fb->dirty, width, height, LCD_DIRTY_WINDOW_COST);
+    LCD_Framebuffer_clearPixels(fb);
+    LCD_Framebuffer_markDirty(fb, 0, 0, width - 1, height - 1);
+
+    // Sin ventana abierta
+    fb->win_x0 = fb->win_x1 = 0;
+    fb->win_y1 = -1;
+    fb->row = 0;
+}
+
+void LCD_Framebuffer_setPalette(LCD_Framebuffer_t *fb, uint8_t first, const uint16_t *colors, uint16_t count) {
+    for (uint16_t i = 0; i < count && first + i < fb->colors; i++) {
+        fb->palette[first + i] = SWAP16(colors[i]);
+    }
+    LCD_Framebuffer_markDirty(fb, 0, 0, fb->width - 1, fb->height - 1);
+}
+
+uint16_t LCD_Framebuffer_getColor(const LCD_Framebuffer_t *fb, uint8_t index) {
+    return SWAP16(fb->palette[index]);
+}
+
+void LCD_Framebuffer_drawPixel(LCD_Framebuffer_t *fb, int16_t x, int16_t y, uint8_t index) {
+    if (x < 0 || y < 0 || x >= fb->width || y >= fb->height) return;
+    LCD_Framebuffer_put(fb, x, y, index);
+
+    // Solo se amplia la caja; LCD_Dirty_add por pixel costaria una busqueda cada vez
+    if (x < fb->pixels.x0) fb->pixels.x0 = x;
+    if (x > fb->pixels.x1) fb->pixels.x1 = x;
+    if (y < fb->pixels.y0) fb->pixels.y0 = y;
+    if (y > fb->pixels.y1) fb->pixels.y1 = y;
+}
+
+uint8_t LCD_Framebuffer_getPixel(const LCD_Framebuffer_t *fb, int16_t x, int16_t y) {
+    if (x < 0 || y < 0 || x >= fb->width || y >= fb->height) return 0;
+    const uint8_t *row = fb->data + (uint32_t)y * fb->stride;
+    if (fb->format == LCD_FRAMEBUFFER_MONO) return (row[x >> 3] >> (7 - (x & 0x07))) & 1;
+    if (fb->format == LCD_FRAMEBUFFER_I8) return row[x];
+    return (x & 1) ? row[x >> 1] & 0x0F : row[x >> 1] >> 4;
+}
+
+void LCD_Framebuffer_fillRect(LCD_Framebuffer_t *fb, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index) {
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 >= fb->width) x1 = fb->width - 1;
+    if (y1 >= fb->height) y1 = fb->height - 1;
+    if (x > x1 || y > y1) return;
+
+    uint8_t *row = fb->data + (uint32_t)y * fb->stride;
+    for (int16_t j = y; j <= y1; j++, row += fb->stride) {
+        LCD_Framebuffer_fillSpan(fb, row, x, x1, index);
+    }
+    LCD_Framebuffer_markDirty(fb, x, y, x1, y1);
+}
+
+void LCD_Framebuffer_fill(LCD_Framebuffer_t *fb, uint8_t index) {
+    if (fb->format == LCD_FRAMEBUFFER_MONO) index = (index & 1) ? 0xFF : 0;
+    if (fb->format == LCD_FRAMEBUFFER_I4) index = (index & 0x0F) * 0x11;
+    memset(fb->data, index, LCD_FRAMEBUFFER_SIZE(fb->format, fb->width, fb->height));
+    LCD_Framebuffer_markDirty(fb, 0, 0, fb->width - 1, fb->height - 1);
+}
+
+void LCD_Framebuffer_drawLine(LCD_Framebuffer_t *fb, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t index) {
+    // Las horizontales y verticales son rectangulos de una fila o columna
+    if (y0 == y1 || x0 == x1) {
+        if (x0 > x1) { int16_t t = x0; x0 = x1; x1 = t; }
+        if (y0 > y1) { int16_t t = y0; y0 = y1; y1 = t; }
+        LCD_Framebuffer_fillRect(fb, x0, y0, x1 - x0 + 1, y1 - y0 + 1, index);
+        return;
+    }
+
+    // Bresenham sobre el buffer, con el mismo recorrido que LCD_GFX_drawLine para
+    // que la linea sea igual en pantalla y en framebuffer
+    int16_t bx0 = x0 < x1 ? x0 : x1, bx1 = x0 < x1 ? x1 : x0;
+    int16_t by0 = y0 < y1 ? y0 : y1, by1 = y0 < y1 ? y1 : y0;
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    int16_t t;
+    if (steep) {
+        t = x0; x0 = y0; y0 = t;
+        t = x1; x1 = y1; y1 = t;
+    }
+    if (x0 > x1) {
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+
+    int16_t dx = x1 - x0;
+    int16_t dy = abs(y1 - y0);
+    int16_t err = dx / 2;
+    int16_t ystep = (y0 < y1) ? 1 : -1;
+
+    for (; x0 <= x1; x0++) {
+        int16_t px = steep ? y0 : x0;
+        int16_t py = steep ? x0 : y0;
+        if (px >= 0 && py >= 0 && px < fb->width && py < fb->height) {
+            LCD_Framebuffer_put(fb, px, py, index);
+        }
+        err -= dy;
+        if (err < 0) {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+    LCD_Framebuffer_invalidate(fb, bx0, by0, bx1 - bx0 + 1, by1 - by0 + 1);
+}
+
+void LCD_Framebuffer_drawChar(LCD_Framebuffer_t *fb, int16_t x, int16_t y, char c, uint8_t index, uint8_t bg) {
+    const uint8_t *glyph = font + (uint8_t)c * 5;
+    bool opaque = (bg != index);
+
+    for (uint8_t i = 0; i < 6; i++) {
+        int16_t col = x + i;
+        uint8_t line = (i < 5) ? glyph[i] : 0;
+        if (col < 0 || col >= fb->width) continue;
+
+        if (fb->format == LCD_FRAMEBUFFER_MONO) {
+            // Cada columna de la fuente es el mismo bit de 8 filas seguidas
+            uint8_t mask = 0x80 >> (col & 0x07);
+            uint8_t on = (index & 1) ? mask : 0;
+            uint8_t off = (bg & 1) ? mask : 0;
+            for (int16_t j = 0; j < 8; j++, line >>= 1) {
+                if (y + j < 0 || y + j >= fb->height) continue;
+                uint8_t *p = fb->data + (uint32_t)(y + j) * fb->stride + (col >> 3);
+                if (line & 1) *p = (*p & ~mask) | on;
+                else if (opaque) *p = (*p & ~mask) | off;
+            }
+        }
+        else {
+            for (int16_t j = 0; j < 8; j++, line >>= 1) {
+                if (y + j < 0 || y + j >= fb->height) continue;
+                if (line & 1) LCD_Framebuffer_put(fb, col, y + j, index);
+                else if (opaque) LCD_Framebuffer_put(fb, col, y + j, bg);
+            }
+        }
+    }
+    LCD_Framebuffer_invalidate(fb, x, y, 6, 8);
+}
+
+void LCD_Framebuffer_setWindow(LCD_Framebuffer_t *fb, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    fb->win_x0 = x0;
+    fb->win_x1 = x1;
+    fb->win_y1 = y1;
+    fb->row = y0;
+
+    // Se marca de una vez toda la ventana
+    LCD_Framebuffer_markDirty(fb, x0, y0, x1, y1);
+}
+
+void LCD_Framebuffer_pushBits(LCD_Framebuffer_t *fb, const uint8_t *bits, uint16_t first,
+                              uint8_t fg, uint8_t bg, uint8_t count) {
+    for (; count > 0 && fb->row <= fb->win_y1; count--, fb->row++) {
+        int16_t y = fb->row;
+        if (y < 0 || y >= fb->height) continue;
+
+        // Parte visible de la fila
+        int16_t x0 = fb->win_x0 < 0 ? 0 : fb->win_x0;
+        int16_t x1 = fb->win_x1 >= fb->width ? fb->width - 1 : fb->win_x1;
+        uint16_t bit = first + (x0 - fb->win_x0);
+        for (int16_t x = x0; x <= x1; x++, bit++) {
+            bool on = bits[bit >> 3] & (0x80 >> (bit & 0x07));
+            LCD_Framebuffer_put(fb, x, y, on ? fg : bg);
+        }
+    }
+}
+
+void LCD_Framebuffer_commit(LCD_Framebuffer_t *fb) {
+    if (fb->pixels.x0 > fb->pixels.x1) return;
+    LCD_Dirty_add(&fb->dirty, fb->pixels.x0, fb->pixels.y0,
+                  fb->pixels.x1 - fb->pixels.x0 + 1, fb->pixels.y1 - fb->pixels.y0 + 1);
+    LCD_Framebuffer_clearPixels(fb);
+}
+
+void LCD_Framebuffer_invalidate(LCD_Framebuffer_t *fb, int16_t x, int16_t y, int16_t w, int16_t h) {
+    LCD_Framebuffer_commit(fb);
+    LCD_Dirty_add(&fb->dirty, x, y, w, h);
+}
+
+/**
+ * @brief Traduce los pixeles [x0, x0 + n) de una fila por la paleta a `dst`.
+ * @return Pixeles de `dst` que preceden al primero de la fila.
+ */
+static uint8_t LCD_Framebuffer_expandRow(const LCD_Framebuffer_t *fb, int16_t y, int16_t x0, uint16_t n, uint32_t *dst) {
+    const uint8_t *row = fb->data + (uint32_t)y * fb->stride;
+    const uint16_t *palette = fb->palette;
+    uint16_t *out = (uint16_t *)dst;
+
+    if (fb->format == LCD_FRAMEBUFFER_MONO) {
+        uint8_t skip = x0 & 0x07;
+        LCD_Expand_1bpp(dst, row + (x0 >> 3), skip + n,
+                        LCD_Framebuffer_getColor(fb, 1), LCD_Framebuffer_getColor(fb, 0));
+        return skip;
+    }
+    if (fb->format == LCD_FRAMEBUFFER_I8) {
+        const uint8_t *src = row + x0;
+        for (uint16_t i = 0; i < n; i++) {
+            out[i] = palette[src[i]];
+        }
+        return 0;
+    }
+
+    // 4 bits: un pixel suelto al principio si x0 es impar y luego de dos en dos
+    const uint8_t *src = row + (x0 >> 1);
+    if (x0 & 1) {
+        *out++ = palette[*src++ & 0x0F];
+        n--;
+    }
+    for (; n >= 2; n -= 2) {
+        uint8_t b = *src++;
+        *out++ = palette[b >> 4];
+        *out++ = palette[b & 0x0F];
+    }
+    if (n) {
+        *out = palette[*src >> 4];
+    }
+    return 0;
+}
+
+/**
+ * @brief Envia un rectangulo del framebuffer con una sola ventana.
+ * 
+ * Cada fila se traduce en un buffer de LCD_Pipeline mientras se envia la anterior.
+ */
+static void LCD_Framebuffer_flushRect(const LCD_Framebuffer_t *fb, const LCD_Dirty_rect_t *r) {
+    int16_t x0 = r->x0, x1 = r->x1;
+    int16_t y0 = r->y0, y1 = r->y1;
+
+    // Recortar a la pantalla
+    if (fb->x + x0 < 0) x0 = -fb->x;
+    if (fb->y + y0 < 0) y0 = -fb->y;
+    if (fb->x + x1 >= ILI9341_width()) x1 = ILI9341_width() - 1 - fb->x;
+    if (fb->y + y1 >= ILI9341_height()) y1 = ILI9341_height() - 1 - fb->y;
+    if (x0 > x1 || y0 > y1) return;
+
+    uint16_t n = x1 - x0 + 1;
+    LCD_Pipeline_begin(fb->x + x0, fb->y + y0, fb->x + x1, fb->y + y1);
+    for (int16_t y = y0; y <= y1; y++) {
+        uint8_t *line = LCD_Pipeline_getBuffer();
+        uint8_t skip = LCD_Framebuffer_expandRow(fb, y, x0, n, (uint32_t *)line);
+        LCD_Pipeline_submit(line + 2 * skip, 2 * n);
+    }
+}
+
+void LCD_Framebuffer_flush(LCD_Framebuffer_t *fb) {
+    LCD_Dirty_rect_t r;
+    LCD_Framebuffer_commit(fb);
+    while (LCD_Dirty_pop(&fb->dirty, &r)) {
+        LCD_Framebuffer_flushRect(fb, &r);
+    }
+    LCD_Pipeline_end();
+}
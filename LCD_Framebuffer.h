@@ -0,0 +1,190 @@
+/**
+ * @file        LCD_Framebuffer.h
+ * @brief       Cabeceras del framebuffer en RAM con color indexado por paleta.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Un framebuffer guarda un índice de paleta por píxel (4 u 8 bits) en
+ *              lugar del color RGB565: una pantalla completa ocupa 38 KB a 4 bits y
+ *              75 KB a 8 bits, frente a 150 KB en RGB565. Con LCD_GFX_setFramebuffer
+ *              las primitivas de LCD_GFX escriben en el framebuffer, con índices en
+ *              lugar de colores, y LCD_Framebuffer_flush envía a la pantalla la zona
+ *              modificada, traduciendo cada fila por la paleta a un buffer RGB565.
+ *              Cambiar la paleta recolorea todo el framebuffer en el siguiente
+ *              volcado sin volver a dibujar (fundidos, temas de color, parpadeos).
+ *
+ *              Para interfaces de dos colores (texto, líneas, iconos) el formato de
+ *              1 bit por píxel ocupa 9,6 KB por pantalla. Sus filas son palabras de
+ *              32 bits, de forma que los tramos horizontales se rellenan palabra a
+ *              palabra, los caracteres se estampan por columnas directamente desde la
+ *              tabla `font`, y en el volcado cada fila se expande con LCD_Expand_1bpp.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Framebuffer.c, LCD_GFX.h
+ */
+
+#ifndef LCD_FRAMEBUFFER_H
+#define LCD_FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LCD_Dirty.h"
+
+// Ancho maximo de un framebuffer (una fila de pantalla apaisada)
+#define LCD_FRAMEBUFFER_MAX_WIDTH 320
+
+/**
+ * @brief Formato de los píxeles del framebuffer.
+ */
+typedef enum {
+    LCD_FRAMEBUFFER_MONO,   // 1 bit por pixel, 2 colores. MSB a la izquierda, filas de palabras de 32 bits
+    LCD_FRAMEBUFFER_I4,     // 4 bits por pixel, 16 colores. Pixel izquierdo en el nibble alto
+    LCD_FRAMEBUFFER_I8      // 8 bits por pixel, 256 colores
+} LCD_Framebuffer_format_t;
+
+// Bytes por fila y tamaño del buffer de un framebuffer
+#define LCD_FRAMEBUFFER_STRIDE(format, w) \
+    ((format) == LCD_FRAMEBUFFER_MONO ? (((w) + 31) / 32) * 4 : \
+     (format) == LCD_FRAMEBUFFER_I4 ? ((w) + 1) / 2 : (w))
+#define LCD_FRAMEBUFFER_SIZE(format, w, h) ((uint32_t)LCD_FRAMEBUFFER_STRIDE(format, w) * (h))
+
+/**
+ * @brief Framebuffer indexado.
+ *
+ * Los campos son internos, se manejan con las funciones LCD_Framebuffer_*.
+ */
+typedef struct {
+    uint8_t *data;
+    LCD_Framebuffer_format_t format;
+    uint16_t stride;                // Bytes por fila
+    int16_t width, height;
+    int16_t x, y;                   // Posicion en la pantalla
+
+    uint16_t palette[256];          // Colores RGB565 con los bytes intercambiados (MSB primero en memoria)
+    uint16_t colors;                // Entradas de la paleta
+
+    // Zonas modificadas desde el ultimo volcado
+    LCD_Dirty_t dirty;
+    LCD_Dirty_rect_t pixels;        // Caja de los pixeles sueltos aun no pasados a `dirty` (vacia si x0 > x1)
+
+    // Ventana de escritura por filas (ver LCD_Framebuffer_setWindow)
+    int16_t win_x0, win_x1, win_y1;
+    int16_t row;
+} LCD_Framebuffer_t;
+
+/**
+ * @brief Inicializa un framebuffer con la paleta a negro y todos los píxeles a 0.
+ *
+ * @param fb Framebuffer a inicializar.
+ * @param buffer Memoria de los píxeles, de LCD_FRAMEBUFFER_SIZE(format, width, height) bytes.
+ *               En LCD_FRAMEBUFFER_MONO debe estar alineada a 4 bytes.
+ * @param format Formato de los píxeles.
+ * @param x Coordenada X de la pantalla en la que se vuelca la esquina superior izquierda.
+ * @param y Coordenada Y de la pantalla en la que se vuelca la esquina superior izquierda.
+ * @param width Ancho en píxeles (máximo LCD_FRAMEBUFFER_MAX_WIDTH).
+ * @param height Alto en píxeles.
+ */
+void LCD_Framebuffer_init(LCD_Framebuffer_t *fb, uint8_t *buffer, LCD_Framebuffer_format_t format,
+                          int16_t x, int16_t y, int16_t width, int16_t height);
+
+/**
+ * @brief Cambia entradas de la paleta. Todo el framebuffer se vuelca en el siguiente flush.
+ *
+ * @param fb Framebuffer.
+ * @param first Primer índice a cambiar.
+ * @param colors Colores RGB565 (BLACK, RED...).
+ * @param count Número de entradas.
+ */
+void LCD_Framebuffer_setPalette(LCD_Framebuffer_t *fb, uint8_t first, const uint16_t *colors, uint16_t count);
+
+/**
+ * @brief Devuelve el color RGB565 de una entrada de la paleta.
+ */
+uint16_t LCD_Framebuffer_getColor(const LCD_Framebuffer_t *fb, uint8_t index);
+
+/**
+ * @brief Escribe un píxel. Las coordenadas fuera del framebuffer se ignoran.
+ */
+void LCD_Framebuffer_drawPixel(LCD_Framebuffer_t *fb, int16_t x, int16_t y, uint8_t index);
+
+/**
+ * @brief Devuelve el índice de un píxel (0 fuera del framebuffer).
+ */
+uint8_t LCD_Framebuffer_getPixel(const LCD_Framebuffer_t *fb, int16_t x, int16_t y);
+
+/**
+ * @brief Rellena un rectángulo de `w` x `h` píxeles, recortado al framebuffer.
+ */
+void LCD_Framebuffer_fillRect(LCD_Framebuffer_t *fb, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index);
+
+/**
+ * @brief Rellena todo el framebuffer.
+ */
+void LCD_Framebuffer_fill(LCD_Framebuffer_t *fb, uint8_t index);
+
+/**
+ * @brief Dibuja una línea entre dos puntos, ambos incluidos, recortada al framebuffer.
+ */
+void LCD_Framebuffer_drawLine(LCD_Framebuffer_t *fb, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t index);
+
+/**
+ * @brief Estampa un carácter de 6x8 píxeles de la fuente `font`.
+ *
+ * @param fb Framebuffer.
+ * @param x Coordenada X de la esquina superior izquierda.
+ * @param y Coordenada Y de la esquina superior izquierda.
+ * @param c Carácter.
+ * @param index Índice del texto.
+ * @param bg Índice del fondo. Si es igual a `index` no se dibuja fondo.
+ */
+void LCD_Framebuffer_drawChar(LCD_Framebuffer_t *fb, int16_t x, int16_t y, char c, uint8_t index, uint8_t bg);
+
+/**
+ * @brief Abre una ventana de escritura por filas, como ILI9341_setWindow.
+ *
+ * Cada llamada posterior a LCD_Framebuffer_pushBits escribe una fila completa de la
+ * ventana, empezando por la de arriba. La ventana puede salirse del framebuffer.
+ */
+void LCD_Framebuffer_setWindow(LCD_Framebuffer_t *fb, int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+/**
+ * @brief Escribe la siguiente fila de la ventana a partir de una fila de bits.
+ *
+ * @param fb Framebuffer.
+ * @param bits Fila de bits, MSB a la izquierda.
+ * @param first Índice del bit que corresponde a la primera columna de la ventana.
+ * @param fg Índice de los bits a 1.
+ * @param bg Índice de los bits a 0.
+ * @param count Número de filas iguales que escribir.
+ */
+void LCD_Framebuffer_pushBits(LCD_Framebuffer_t *fb, const uint8_t *bits, uint16_t first,
+                              uint8_t fg, uint8_t bg, uint8_t count);
+
+/**
+ * @brief Pasa a las zonas modificadas la caja de los píxeles sueltos dibujados.
+ *
+ * LCD_Framebuffer_drawPixel solo amplía una caja, en lugar de añadir cada píxel a
+ * LCD_Dirty. Esta función la añade de una vez; se llama al terminar cada primitiva
+ * (LCD_GFX_sync lo hace), y también la llaman las demás funciones de dibujo y
+ * LCD_Framebuffer_flush.
+ */
+void LCD_Framebuffer_commit(LCD_Framebuffer_t *fb);
+
+/**
+ * @brief Marca una zona como modificada para volcarla en el siguiente flush.
+ */
+void LCD_Framebuffer_invalidate(LCD_Framebuffer_t *fb, int16_t x, int16_t y, int16_t w, int16_t h);
+
+/**
+ * @brief Envía a la pantalla la zona modificada desde el último volcado.
+ *
+ * Cada rectángulo de LCD_Dirty se envía con una sola ventana; cada fila se traduce
+ * por la paleta a un buffer RGB565 y se envía en una ráfaga. En LCD_FRAMEBUFFER_MONO el índice 0 es el
+ * fondo y el 1 el primer plano.
+ */
+void LCD_Framebuffer_flush(LCD_Framebuffer_t *fb);
+
+#endif
@@ -19,47 +19,444 @@
  */
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include "LCD_GFX.h"
 #include "ILI9341.h"
+#include "LCD_Expand.h"
+#include "LCD_Framebuffer.h"
+#include "LCD_Pipeline.h"
 #include "bitmaps.h"
 
 #define pgm_read_byte(addr) (*(const unsigned char *)(addr))
 
 
+// Framebuffer en el que se dibuja, o NULL para dibujar en la pantalla
+static LCD_Framebuffer_t *target = NULL;
+
 void LCD_GFX_init() {
     ILI9341_init();
-    rotation_direction_GFX = 0;
+    LCD_Pipeline_init();
 }
 
 // ------------------------
 // Utils, unicos módulos que usan ILI9341.h
 // -----------------------
 void LCD_GFX_fillScreen(uint16_t color) {
+    if (target != NULL) {
+        LCD_Framebuffer_fill(target, color);
+        return;
+    }
     ILI9341_fillScreen(color);
 }
 
 void LCD_GFX_drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (target != NULL) {
+        LCD_Framebuffer_drawPixel(target, x, y, color);
+        return;
+    }
     ILI9341_drawPixel(x, y, color);
 }
 
+void LCD_GFX_sync(void) {
+    if (target != NULL) {
+        LCD_Framebuffer_commit(target);
+        return;
+    }
+    ILI9341_sync();
+}
+
 void LCD_GFX_setRotation(uint8_t dir) {
     ILI9341_setRotation(dir);
-    rotation_direction_GFX = dir;
 }
 
-void LCD_GFX_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
-    ILI9341_setRotation(0);
-    int16_t byteWidth = (w+7)/8;
-    for (uint16_t j = 0; j < h; j++) {
-        for (uint16_t i = 0; i < w; i++){
-            unsigned char byte = pgm_read_byte(bitmap + j * byteWidth + i / 8);
-            if (byte & (0x80 >> (i & 0x07))) {
-                LCD_GFX_drawPixel(x+i, y+j, color);
+uint8_t LCD_GFX_getRotation(void) {
+    return ILI9341_getRotation();
+}
+
+int16_t LCD_GFX_width(void) {
+    return target != NULL ? target->width : ILI9341_width();
+}
+
+int16_t LCD_GFX_height(void) {
+    return target != NULL ? target->height : ILI9341_height();
+}
+
+void LCD_GFX_setFramebuffer(LCD_Framebuffer_t *fb) {
+    if (fb != NULL) ILI9341_sync();
+    target = fb;
+}
+
+LCD_Framebuffer_t *LCD_GFX_getFramebuffer(void) {
+    return target;
+}
+
+/**
+ * @brief Rellena un rectangulo de `w` x `h` pixeles en el destino actual.
+ */
+static void LCD_GFX_fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (target != NULL) {
+        LCD_Framebuffer_fillRect(target, x, y, w, h, color);
+        return;
+    }
+    ILI9341_fillRect(x, y, w, h, color);
+}
+
+/**
+ * @brief Abre una ventana de escritura por filas en el destino actual.
+ */
+static void LCD_GFX_setWindow(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    if (target != NULL) {
+        LCD_Framebuffer_setWindow(target, x0, y0, x1, y1);
+        return;
+    }
+    ILI9341_setWindow(x0, y0, x1, y1);
+}
+
+// ------------------
+// Imagenes
+// ------------------
+#define IMAGE_MAX_WIDTH 320
+
+// Buffer de una fila de pixeles listos para enviar, alineado para LCD_Expand_1bpp
+static uint32_t line_buffer[IMAGE_MAX_WIDTH / 2];
+
+#if LCD_PIPELINE_BUFFER_SIZE < 2 * IMAGE_MAX_WIDTH
+#error "LCD_PIPELINE_BUFFER_SIZE no admite una fila de IMAGE_MAX_WIDTH"
+#endif
+
+/**
+ * @brief Escribe `count` veces la siguiente fila de la ventana a partir de una fila de bits.
+ * 
+ * @param bits Fila de bits, MSB a la izquierda.
+ * @param first Bit de la primera columna de la ventana.
+ * @param n Columnas de la ventana.
+ */
+static void LCD_GFX_pushBits(const uint8_t *bits, uint16_t first, uint16_t n,
+                             uint16_t fg, uint16_t bg, uint8_t count) {
+    if (target != NULL) {
+        LCD_Framebuffer_pushBits(target, bits, first, fg, bg, count);
+        return;
+    }
+
+    LCD_Expand_1bpp(line_buffer, bits, first + n, fg, bg);
+    for (; count > 0; count--) {
+        ILI9341_pushPixels((const uint8_t *)line_buffer + 2 * first, 2 * n);
+    }
+}
+
+/**
+ * @brief Estado del descompresor RLE de las imagenes.
+ * 
+ * Cada paquete empieza con un byte de cabecera `h`: si h < 128 le siguen h+1
+ * unidades literales; si no, le sigue una unidad que se repite (h & 0x7F) + 2 veces.
+ * La unidad es un byte en BITMAP_FORMAT_MONO_RLE y un pixel en BITMAP_FORMAT_RGB565_RLE.
+ */
+typedef struct {
+    const uint8_t *src;     // Siguiente byte del flujo comprimido
+    const uint8_t *value;   // Unidad que se repite en el paquete actual
+    uint8_t unit;           // Bytes por unidad
+    uint8_t count;          // Unidades que quedan del paquete actual
+    bool repeat;            // El paquete actual es de repeticion
+} rle_reader_t;
+
+/**
+ * @brief Descomprime las siguientes `units` unidades del flujo RLE.
+ * 
+ * Los paquetes pueden continuar de una fila a la siguiente, por lo que el estado
+ * se conserva en `r` entre llamadas.
+ */
+static void LCD_GFX_rleRead(rle_reader_t *r, uint8_t *dst, uint16_t units) {
+    while (units > 0) {
+        if (r->count == 0) {
+            uint8_t h = *r->src++;
+            r->repeat = h & 0x80;
+            if (r->repeat) {
+                r->count = (h & 0x7F) + 2;
+                r->value = r->src;
+                r->src += r->unit;
             }
+            else {
+                r->count = h + 1;
+            }
+        }
+
+        uint16_t n = r->count < units ? r->count : units;
+        if (!r->repeat) {
+            memcpy(dst, r->src, n * r->unit);
+            r->src += n * r->unit;
         }
+        else if (r->unit == 1) {
+            memset(dst, r->value[0], n);
+        }
+        else {
+            for (uint16_t i = 0; i < n; i++) {
+                dst[2*i] = r->value[0];
+                dst[2*i+1] = r->value[1];
+            }
+        }
+        dst += n * r->unit;
+        units -= n;
+        r->count -= n;
     }
 }
 
+void LCD_GFX_drawImage(int16_t x, int16_t y, const bitmap_t *img, uint16_t fg, uint16_t bg) {
+    uint8_t bits[IMAGE_MAX_WIDTH / 8];
+    int16_t w = img->width;
+    int16_t h = img->height;
+    int16_t byteWidth = (w + 7) / 8;
+
+    if (img->format == BITMAP_FORMAT_FONT || w > IMAGE_MAX_WIDTH) return;
+
+    bool mono = (img->format == BITMAP_FORMAT_MONO || img->format == BITMAP_FORMAT_MONO_RLE);
+    bool direct = (target == NULL);
+    if (!mono && !direct) return;
+
+    // Recortar a la zona visible
+    int16_t x0 = x < 0 ? 0 : x;
+    int16_t y0 = y < 0 ? 0 : y;
+    int16_t x1 = (x + w > LCD_WIDTH) ? LCD_WIDTH - 1 : x + w - 1;
+    int16_t y1 = (y + h > LCD_HEIGHT) ? LCD_HEIGHT - 1 : y + h - 1;
+    if (x0 > x1 || y0 > y1) return;
+
+    uint32_t skip = 2 * (x0 - x);
+    uint32_t len = 2 * (x1 - x0 + 1);
+    rle_reader_t rle = { .src = img->data, .unit = (img->format == BITMAP_FORMAT_RGB565_RLE) ? 2 : 1 };
+
+    if (direct) {
+        LCD_Pipeline_begin(x0, y0, x1, y1);
+    }
+    else {
+        LCD_GFX_setWindow(x0, y0, x1, y1);
+    }
+    for (int16_t j = 0; j <= y1 - y; j++) {
+        bool visible = (y + j >= y0);
+
+        // En la pantalla cada fila visible se prepara en un buffer de LCD_Pipeline
+        // mientras se envia la anterior
+        uint8_t *line = (direct && visible) ? LCD_Pipeline_getBuffer() : (uint8_t *)line_buffer;
+        const uint8_t *row = line;
+
+        // Las imagenes comprimidas se decodifican aunque la fila no sea visible
+        switch (img->format) {
+            case BITMAP_FORMAT_RGB565:
+                row = img->data + 2 * (uint32_t)j * w;
+                break;
+            case BITMAP_FORMAT_RGB565_RLE:
+                LCD_GFX_rleRead(&rle, line, w);
+                break;
+            case BITMAP_FORMAT_MONO:
+                row = img->data + (uint32_t)j * byteWidth;
+                break;
+            case BITMAP_FORMAT_MONO_RLE:
+                LCD_GFX_rleRead(&rle, bits, byteWidth);
+                row = bits;
+                break;
+            default:
+                break;
+        }
+        if (!visible) continue;
+
+        if (!direct) {
+            LCD_GFX_pushBits(row, x0 - x, x1 - x0 + 1, fg, bg, 1);
+            continue;
+        }
+        if (mono) {
+            LCD_Expand_1bpp((uint32_t *)line, row, x1 - x + 1, fg, bg);
+        }
+        else if (row != line) {
+            // EasyDMA solo lee de RAM
+            memcpy(line + skip, row + skip, len);
+        }
+        LCD_Pipeline_submit(line + skip, len);
+    }
+    if (direct) LCD_Pipeline_end();
+}
+
+void LCD_GFX_drawRGBBitmap(int16_t x, int16_t y, const uint16_t *src, int16_t stride,
+                           int16_t sx, int16_t sy, int16_t w, int16_t h) {
+    if (target != NULL) return;
+
+    // Recortar el rectangulo a la imagen origen; su alto no se conoce, solo por arriba
+    if (sx < 0) { x -= sx; w += sx; sx = 0; }
+    if (sy < 0) { y -= sy; h += sy; sy = 0; }
+    if (sx + w > stride) w = stride - sx;
+    if (w <= 0 || h <= 0) return;
+
+    // Recortar a la zona visible
+    int16_t x0 = x < 0 ? 0 : x;
+    int16_t y0 = y < 0 ? 0 : y;
+    int16_t x1 = (x + w > LCD_WIDTH) ? LCD_WIDTH - 1 : x + w - 1;
+    int16_t y1 = (y + h > LCD_HEIGHT) ? LCD_HEIGHT - 1 : y + h - 1;
+    if (x0 > x1 || y0 > y1) return;
+
+    const uint8_t *row = (const uint8_t *)src + 2 * ((uint32_t)(sy + y0 - y) * stride + sx + x0 - x);
+    uint32_t len = 2 * (x1 - x0 + 1);
+
+    // Una sola ventana para todo el rectangulo y una rafaga por fila
+    ILI9341_setWindow(x0, y0, x1, y1);
+    for (int16_t j = y0; j <= y1; j++) {
+        ILI9341_pushPixels(row, len);
+        row += 2 * stride;
+    }
+}
+
+void LCD_GFX_drawSprite(int16_t x, int16_t y, const bitmap_t *sheet, int16_t sx, int16_t sy, int16_t w, int16_t h) {
+    if (sheet->format != BITMAP_FORMAT_RGB565) return;
+    if (sy + h > sheet->height) h = sheet->height - sy;
+    LCD_GFX_drawRGBBitmap(x, y, (const uint16_t *)sheet->data, sheet->width, sx, sy, w, h);
+}
+
+// ------------------
+// Rotacion por software
+// ------------------
+/**
+ * @brief Imagen sin comprimir que se vuelca girada, opcionalmente escalada.
+ */
+typedef struct {
+    const uint8_t *data;
+    uint16_t stride;        // Bytes por fila
+    int16_t w, h;           // Dimensiones ya escaladas
+    uint8_t scale;          // Cada pixel de `data` ocupa scale x scale
+    bool mono;              // 1 bit por pixel (MSB a la izquierda) o RGB565 (MSB primero)
+} blit_src_t;
+
+/**
+ * @brief Pixel de la imagen que cae en (i, j) del rectangulo de destino y avance por columna.
+ * 
+ * La orientacion r gira la imagen r * 90 grados en sentido horario.
+ */
+static void LCD_GFX_blitMap(const blit_src_t *src, uint8_t r, int16_t i, int16_t j,
+                            int16_t *u, int16_t *v, int8_t *du, int8_t *dv) {
+    switch (r & 3) {
+        case 1:
+            *u = j;              *v = src->h - 1 - i; *du = 0;  *dv = -1;
+            break;
+        case 2:
+            *u = src->w - 1 - i; *v = src->h - 1 - j; *du = -1; *dv = 0;
+            break;
+        case 3:
+            *u = src->w - 1 - j; *v = i;              *du = 0;  *dv = 1;
+            break;
+        default:
+            *u = i;              *v = j;              *du = 1;  *dv = 0;
+    }
+}
+
+/**
+ * @brief Indica si el pixel (u, v) de una imagen de 1 bit por pixel esta a 1.
+ */
+static inline bool LCD_GFX_blitBit(const blit_src_t *src, int16_t u, int16_t v) {
+    u /= src->scale;
+    v /= src->scale;
+    return src->data[v * src->stride + (u >> 3)] & (0x80 >> (u & 0x07));
+}
+
+/**
+ * @brief Recorta el rectangulo de destino de una imagen girada a la pantalla.
+ * @return false si no queda nada visible.
+ */
+static bool LCD_GFX_blitClip(int16_t x, int16_t y, const blit_src_t *src, uint8_t r,
+                             int16_t *x0, int16_t *y0, int16_t *x1, int16_t *y1) {
+    int16_t w = (r & 1) ? src->h : src->w;
+    int16_t h = (r & 1) ? src->w : src->h;
+
+    *x0 = x < 0 ? 0 : x;
+    *y0 = y < 0 ? 0 : y;
+    *x1 = (x + w > LCD_WIDTH) ? LCD_WIDTH - 1 : x + w - 1;
+    *y1 = (y + h > LCD_HEIGHT) ? LCD_HEIGHT - 1 : y + h - 1;
+    return *x0 <= *x1 && *y0 <= *y1;
+}
+
+/**
+ * @brief Vuelca una imagen girada con una sola ventana.
+ * 
+ * Las filas se recorren en el orden de la GRAM (el de la rotacion actual, sin tocar
+ * MADCTL) y cada fila visible se compone en line_buffer y se envia en una rafaga;
+ * lo que cambia con la orientacion es el recorrido de la imagen origen.
+ */
+static void LCD_GFX_blit(int16_t x, int16_t y, const blit_src_t *src, uint8_t r, uint16_t fg, uint16_t bg) {
+    uint8_t *line = (uint8_t *)line_buffer;
+    uint8_t bits[IMAGE_MAX_WIDTH / 8];
+    int16_t x0, y0, x1, y1;
+
+    if (!LCD_GFX_blitClip(x, y, src, r, &x0, &y0, &x1, &y1)) return;
+    if (!src->mono && target != NULL) return;
+    int16_t n = x1 - x0 + 1;
+
+    LCD_GFX_setWindow(x0, y0, x1, y1);
+    for (int16_t j = y0 - y; j <= y1 - y; j++) {
+        int16_t u, v;
+        int8_t du, dv;
+        LCD_GFX_blitMap(src, r, x0 - x, j, &u, &v, &du, &dv);
+
+        if (src->mono) {
+            memset(bits, 0, (n + 7) / 8);
+            for (int16_t k = 0; k < n; k++, u += du, v += dv) {
+                if (LCD_GFX_blitBit(src, u, v)) bits[k >> 3] |= 0x80 >> (k & 0x07);
+            }
+            LCD_GFX_pushBits(bits, 0, n, fg, bg, 1);
+        }
+        else {
+            for (int16_t k = 0; k < n; k++, u += du, v += dv) {
+                const uint8_t *p = src->data + (uint32_t)(v / src->scale) * src->stride + 2 * (u / src->scale);
+                line[2 * k] = p[0];
+                line[2 * k + 1] = p[1];
+            }
+            ILI9341_pushPixels(line, 2 * n);
+        }
+    }
+}
+
+/**
+ * @brief Dibuja solo los bits a 1 de una imagen de 1 bit por pixel girada.
+ * 
+ * Se recorre el destino en el orden de la GRAM, de forma que los pixeles seguidos
+ * de una fila se agrupan en la misma rafaga de LCD_GFX_drawPixel.
+ */
+static void LCD_GFX_blitTransparent(int16_t x, int16_t y, const blit_src_t *src, uint8_t r, uint16_t color) {
+    int16_t x0, y0, x1, y1;
+
+    if (!LCD_GFX_blitClip(x, y, src, r, &x0, &y0, &x1, &y1)) return;
+
+    for (int16_t j = y0 - y; j <= y1 - y; j++) {
+        int16_t u, v;
+        int8_t du, dv;
+        LCD_GFX_blitMap(src, r, x0 - x, j, &u, &v, &du, &dv);
+        for (int16_t i = x0 - x; i <= x1 - x; i++, u += du, v += dv) {
+            if (LCD_GFX_blitBit(src, u, v)) LCD_GFX_drawPixel(x + i, y + j, color);
+        }
+    }
+    LCD_GFX_sync();
+}
+
+void LCD_GFX_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
+    blit_src_t src = { .data = bitmap, .stride = (w + 7) / 8, .w = w, .h = h, .scale = 1, .mono = true };
+    LCD_GFX_blitTransparent(x, y, &src, 0, color);
+}
+
+void LCD_GFX_drawImageRotated(int16_t x, int16_t y, const bitmap_t *img, uint16_t fg, uint16_t bg, uint8_t orientation) {
+    orientation &= 3;
+    if (orientation == 0) {
+        LCD_GFX_drawImage(x, y, img, fg, bg);
+        return;
+    }
+
+    // Las imagenes comprimidas solo se pueden leer en orden
+    if (img->format != BITMAP_FORMAT_MONO && img->format != BITMAP_FORMAT_RGB565) return;
+
+    bool mono = img->format == BITMAP_FORMAT_MONO;
+    blit_src_t src = {
+        .data = img->data,
+        .stride = mono ? (img->width + 7) / 8 : 2 * img->width,
+        .w = img->width,
+        .h = img->height,
+        .scale = 1,
+        .mono = mono
+    };
+    LCD_GFX_blit(x, y, &src, orientation, fg, bg);
+}
+
 // ------------------
 // Circulos
 // ------------------
@@ -94,6 +491,7 @@ void LCD_GFX_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
         LCD_GFX_drawPixel(x0 + y, y0 - x, color);
         LCD_GFX_drawPixel(x0 - y, y0 - x, color);
     }
+    LCD_GFX_sync();
 }
 void LCD_GFX_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
     int16_t f     = 1 - r;
@@ -126,17 +524,20 @@ void LCD_GFX_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
 // Lineas
 // ------------------
 void LCD_GFX_drawHLine(int16_t x0, int16_t y0, int16_t line_size, uint16_t color) {
-    for (int16_t x = x0; x <= x0 + line_size; x++) {
-        LCD_GFX_drawPixel(x, y0, color);
-    }
+    if (line_size < 0) return;
+    LCD_GFX_fill(x0, y0, line_size + 1, 1, color);
 }
 
 void LCD_GFX_drawVLine(int16_t x0, int16_t y0, int16_t line_size, uint16_t color) {
-    for (int16_t y = y0; y <= y0 + line_size; y++) {
-        LCD_GFX_drawPixel(x0, y, color);
-    }
+    if (line_size < 0) return;
+    LCD_GFX_fill(x0, y0, 1, line_size + 1, color);
 }
 void LCD_GFX_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (target != NULL) {
+        LCD_Framebuffer_drawLine(target, x0, y0, x1, y1, color);
+        return;
+    }
+
     int16_t steep = abs(y1 - y0) > abs(x1 - x0);
     if (steep) {
         swap(x0, y0);
@@ -175,6 +576,7 @@ void LCD_GFX_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c
             err += dx;
         }
     }
+    LCD_GFX_sync();
 }
 
 // ------------------
@@ -186,17 +588,65 @@ void LCD_GFX_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color
 
     LCD_GFX_drawVLine(x, y, h, color);      // (x,y) -> (x,y+h)
     LCD_GFX_drawVLine(x+w, y, h, color);   // (x+w,y) -> (x+w,y+h)
+    LCD_GFX_sync();
 }
 
 void LCD_GFX_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-    for (int16_t i = x; i < x+w; i++) {
-        LCD_GFX_drawVLine(i, y, h,color);
-    }
+    if (w <= 0 || h < 0) return;
+    // Filas de y a y+h, ambas incluidas, como el resto de primitivas
+    LCD_GFX_fill(x, y, w, h + 1, color);
 }
 
 // ------------------
 // Texto
 // ------------------
+/**
+ * @brief Traspone las columnas de un caracter de la fuente (LSB arriba) a 8 filas
+ * de bits (MSB a la izquierda). La sexta columna, de separacion, queda a 0.
+ */
+static void LCD_GFX_glyphRows(char c, uint8_t rows[8]) {
+    memset(rows, 0, 8);
+    for (uint8_t i = 0; i < 5; i++) {
+        uint8_t line = pgm_read_byte(font+((uint8_t)c*5)+i);
+        for (uint8_t j = 0; j < 8; j++) {
+            if (line & (1 << j)) {
+                rows[j] |= 0x80 >> i;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Dibuja un caracter con fondo en una unica ventana de 6x8 pixeles (escalada).
+ * 
+ * Las columnas de la fuente se trasponen a filas de bits, que se escalan y se
+ * expanden a RGB565 con LCD_Expand_1bpp. El caracter debe estar entero en pantalla.
+ */
+static void LCD_GFX_drawCharOpaque(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg, uint8_t size) {
+    uint8_t rows[8];
+    uint8_t bits[IMAGE_MAX_WIDTH / 8];
+    uint16_t w = 6 * size;
+
+    LCD_GFX_glyphRows(c, rows);
+
+    LCD_GFX_setWindow(x, y, x + w - 1, y + 8 * size - 1);
+    for (uint8_t j = 0; j < 8; j++) {
+        // Escalar la fila horizontalmente
+        if (size == 1) {
+            bits[0] = rows[j];
+        }
+        else {
+            memset(bits, 0, (w + 7) / 8);
+            for (uint16_t i = 0; i < w; i++) {
+                if (rows[j] & (0x80 >> (i / size))) {
+                    bits[i >> 3] |= 0x80 >> (i & 0x07);
+                }
+            }
+        }
+        LCD_GFX_pushBits(bits, 0, w, color, bg, size);
+    }
+}
+
 void LCD_GFX_drawChar(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg, uint8_t size) {
     if  ((x >= LCD_WIDTH)        || // Clip right
         (y >= LCD_HEIGHT)        || // Clip bottom
@@ -204,6 +654,19 @@ void LCD_GFX_drawChar(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg,
         ((y + 8 * size - 1) < 0))   // Clip top
    return;
 
+   // En un framebuffer el caracter se estampa directamente desde la fuente
+   if (target != NULL && size == 1) {
+        LCD_Framebuffer_drawChar(target, x, y, c, color, bg);
+        return;
+   }
+
+   // Con fondo y entero en pantalla se envia en una sola rafaga
+   if (bg != color && x >= 0 && y >= 0 && x + 6 * size <= LCD_WIDTH &&
+       y + 8 * size <= LCD_HEIGHT && 6 * size <= IMAGE_MAX_WIDTH) {
+        LCD_GFX_drawCharOpaque(x, y, c, color, bg, size);
+        return;
+   }
+
    // Bucle sobre las columnas de pixeles del caracter
    for (uint8_t i = 0; i < 6; i++) {
         uint8_t line;
@@ -220,7 +683,7 @@ void LCD_GFX_drawChar(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg,
                     LCD_GFX_drawPixel(x+i, y+j, color);
                 }
                 else {  // Tamaño aumentado
-                    LCD_GFX_fillRect(x+(i*size), y+(j*size), size, size, color);
+                    LCD_GFX_fillRect(x+(i*size), y+(j*size), size, size - 1, color);
                 }
             }
             else if (bg != color){  // Si el fondo es distinto del color de la letra
@@ -228,12 +691,13 @@ void LCD_GFX_drawChar(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg,
                     LCD_GFX_drawPixel(x+i, y+j, bg);
                 }
                 else {
-                    LCD_GFX_fillRect(x+(i*size), y+(j*size), size, size, bg);
+                    LCD_GFX_fillRect(x+(i*size), y+(j*size), size, size - 1, bg);
                 }
             }
             line >>= 1; // Leer siguiente bit
         }
    }
+   LCD_GFX_sync();
 }
 
 void LCD_GFX_drawString(int16_t x, int16_t y, char* c, uint16_t color, uint16_t bg, uint8_t size) {
@@ -260,3 +724,43 @@ void LCD_GFX_drawString(int16_t x, int16_t y, char* c, uint16_t color, uint16_t
     }
 }
 
+void LCD_GFX_drawStringRotated(int16_t x, int16_t y, char* c, uint16_t color, uint16_t bg, uint8_t size, uint8_t orientation) {
+    // Avance entre caracteres y entre lineas (en unidades de size) en cada orientacion
+    static const int8_t advance[4][2] = { {6, 0}, {0, 6}, {-6, 0}, {0, -6} };
+    static const int8_t newline[4][2] = { {0, 8}, {-8, 0}, {0, -8}, {8, 0} };
+    uint8_t r = orientation & 3;
+    int16_t line_x = x, line_y = y;
+    int16_t cursor_x = x, cursor_y = y;
+    uint8_t rows[8];
+
+    for (const char *p = c; *p; p++) {
+        if (*p == '\n') {
+            line_x += newline[r][0] * size;
+            line_y += newline[r][1] * size;
+            cursor_x = line_x;
+            cursor_y = line_y;
+            continue;
+        }
+        if (*p == '\r') {
+            cursor_x = line_x;
+            cursor_y = line_y;
+            continue;
+        }
+
+        if (r == 0) {
+            LCD_GFX_drawChar(cursor_x, cursor_y, *p, color, bg, size);
+        }
+        else {
+            LCD_GFX_glyphRows(*p, rows);
+            blit_src_t src = { .data = rows, .stride = 1, .w = 6 * size, .h = 8 * size, .scale = size, .mono = true };
+            if (bg != color) {
+                LCD_GFX_blit(cursor_x, cursor_y, &src, r, color, bg);
+            }
+            else {
+                LCD_GFX_blitTransparent(cursor_x, cursor_y, &src, r, color);
+            }
+        }
+        cursor_x += advance[r][0] * size;
+        cursor_y += advance[r][1] * size;
+    }
+}
@@ -11,6 +11,7 @@
  * 
  *              El módulo depende de una implementación a un nivel inferior, en este caso
  *              al módulo ILI9341 que es el que se comunica a nivel hardware con la pantalla.
+ *              Se dibuja en la pantalla seleccionada con ILI9341_bind.
  * 
  * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
  *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025, 
@@ -22,9 +23,19 @@
 #define LCD_GFX_H
 
 #include <stdint.h>
+#include "bitmaps.h"
+#include "LCD_Framebuffer.h"
 
-#define LCD_HEIGHT ((rotation_direction_GFX % 2 == 0) ? 320 : 240)
-#define LCD_WIDTH  ((rotation_direction_GFX % 2 == 0) ? 240 : 320)
+// Dimensiones de la pantalla seleccionada en su rotacion actual, constantes si la
+// rotacion es fija (ver ILI9341_FIXED_ROTATION)
+#ifdef ILI9341_FIXED_ROTATION
+#include "ILI9341.h"
+#define LCD_HEIGHT ILI9341_FIXED_HEIGHT
+#define LCD_WIDTH  ILI9341_FIXED_WIDTH
+#else
+#define LCD_HEIGHT LCD_GFX_height()
+#define LCD_WIDTH  LCD_GFX_width()
+#endif
 #define swap(a, b) { int16_t t = a; a = b; b = t; }
 
 // Colores en formato RGB565
@@ -37,7 +48,10 @@
 #define YELLOW  0xFFE0
 #define WHITE   0xFFFF
 
-static int rotation_direction_GFX = 0;
+// Color RGB565 con los bytes intercambiados, para que en memoria quede el MSB
+// primero y pueda enviarse tal cual (ver LCD_GFX_drawRGBBitmap)
+#define RGB565_BE(c) ((uint16_t)((((c) >> 8) & 0xFF) | (((c) & 0xFF) << 8)))
+
 /**
  * @brief Inicializa la pantalla LCD.
  */
@@ -49,12 +63,44 @@ void LCD_GFX_init(void);
  */
 void LCD_GFX_setRotation(uint8_t dir);
 
+/**
+ * @brief Devuelve la rotacion actual de la pantalla [0-3].
+ */
+uint8_t LCD_GFX_getRotation(void);
+
+/**
+ * @brief Ancho de la pantalla en píxeles en la rotación actual.
+ */
+int16_t LCD_GFX_width(void);
+
+/**
+ * @brief Alto de la pantalla en píxeles en la rotación actual.
+ */
+int16_t LCD_GFX_height(void);
+
+/**
+ * @brief Redirige el dibujo a un framebuffer en RAM.
+ * 
+ * Mientras haya un framebuffer seleccionado las coordenadas son relativas a él, los
+ * colores son índices de su paleta y nada se envía a la pantalla hasta llamar a
+ * LCD_Framebuffer_flush. LCD_GFX_width y LCD_GFX_height devuelven sus dimensiones.
+ * Las imágenes y sprites RGB565 no se pueden dibujar en un framebuffer y se ignoran.
+ * 
+ * @param fb Framebuffer destino, o NULL para volver a dibujar directamente en la pantalla.
+ */
+void LCD_GFX_setFramebuffer(LCD_Framebuffer_t *fb);
+
+/**
+ * @brief Devuelve el framebuffer seleccionado, o NULL si se dibuja en la pantalla.
+ */
+LCD_Framebuffer_t *LCD_GFX_getFramebuffer(void);
+
 /**
  * @brief Dibuja una imagen en la pantalla a partir de un bitmap.
  * 
  * Esta función dibuja un bitmap de tamaño `w` x `h` en las coordenadas (`x`, `y`) de la pantalla, 
  * utilizando el color especificado. El bitmap debe ser una imagen en formato de bits donde cada bit 
- * representa un píxel.
+ * representa un píxel. Los bits a 0 no se dibujan. Se dibuja en la rotación actual.
  * 
  * @param x Coordenada X del punto superior izquierdo donde se dibujará el bitmap.
  * @param y Coordenada Y del punto superior izquierdo donde se dibujará el bitmap.
@@ -66,6 +112,77 @@ void LCD_GFX_setRotation(uint8_t dir);
  */
 void LCD_GFX_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
 
+/**
+ * @brief Dibuja una imagen descrita por un bitmap_t, descomprimiéndola si es necesario.
+ * 
+ * La imagen se envía fila a fila a una única ventana de la pantalla, sin
+ * descomprimirla entera en memoria. Se recorta a la zona visible de la pantalla.
+ * Formatos soportados: BITMAP_FORMAT_MONO, BITMAP_FORMAT_MONO_RLE, BITMAP_FORMAT_RGB565
+ * y BITMAP_FORMAT_RGB565_RLE. Las imágenes se generan con tools/img2c.py.
+ * 
+ * @param x Coordenada X de la esquina superior izquierda de la imagen.
+ * @param y Coordenada Y de la esquina superior izquierda de la imagen.
+ * @param img Descriptor de la imagen (ancho máximo 320 píxeles).
+ * @param fg Color de los bits a 1 en las imágenes monocromo.
+ * @param bg Color de los bits a 0 en las imágenes monocromo.
+ */
+void LCD_GFX_drawImage(int16_t x, int16_t y, const bitmap_t *img, uint16_t fg, uint16_t bg);
+
+/**
+ * @brief Dibuja una imagen girada un múltiplo de 90 grados respecto a la rotación actual.
+ * 
+ * El giro se hace al leer la imagen, sin cambiar la rotación de la pantalla (MADCTL):
+ * las filas se siguen enviando en el orden de la GRAM, una ráfaga por fila y una sola
+ * ventana para toda la imagen. Las imágenes comprimidas con RLE solo pueden leerse en
+ * orden, por lo que solo se dibujan con orientación 0.
+ * 
+ * @param x Coordenada X de la esquina superior izquierda de la imagen ya girada.
+ * @param y Coordenada Y de la esquina superior izquierda de la imagen ya girada.
+ * @param img Descriptor de la imagen (BITMAP_FORMAT_MONO o BITMAP_FORMAT_RGB565).
+ * @param fg Color de los bits a 1 en las imágenes monocromo.
+ * @param bg Color de los bits a 0 en las imágenes monocromo.
+ * @param orientation Giro en sentido horario, en pasos de 90 grados [0-3].
+ */
+void LCD_GFX_drawImageRotated(int16_t x, int16_t y, const bitmap_t *img, uint16_t fg, uint16_t bg, uint8_t orientation);
+
+/**
+ * @brief Dibuja una zona rectangular de una imagen RGB565 a todo color.
+ * 
+ * Copia el rectángulo de `w` x `h` píxeles que empieza en (`sx`, `sy`) de la imagen
+ * origen a las coordenadas (`x`, `y`) de la pantalla. Permite dibujar elementos de
+ * una hoja de sprites o de un atlas de iconos. Respeta la rotación actual, se
+ * recorta a la zona visible y cada fila visible se envía en una única ráfaga. El
+ * rectángulo origen se recorta al ancho `stride` y a partir de la fila 0; el
+ * llamante debe asegurar que no pasa de la última fila de la imagen.
+ * 
+ * @param x Coordenada X de destino.
+ * @param y Coordenada Y de destino.
+ * @param src Píxeles de la imagen origen, con los bytes ya intercambiados (MSB primero
+ *            en memoria, ver RGB565_BE), de forma que se envían sin convertir.
+ * @param stride Ancho de una fila de la imagen origen, en píxeles.
+ * @param sx Coordenada X del rectángulo dentro de la imagen origen.
+ * @param sy Coordenada Y del rectángulo dentro de la imagen origen.
+ * @param w Ancho del rectángulo en píxeles.
+ * @param h Alto del rectángulo en píxeles.
+ */
+void LCD_GFX_drawRGBBitmap(int16_t x, int16_t y, const uint16_t *src, int16_t stride,
+                           int16_t sx, int16_t sy, int16_t w, int16_t h);
+
+/**
+ * @brief Dibuja un elemento de una hoja de sprites en formato BITMAP_FORMAT_RGB565.
+ * 
+ * La parte del rectángulo que queda fuera de la hoja no se dibuja.
+ * 
+ * @param x Coordenada X de destino.
+ * @param y Coordenada Y de destino.
+ * @param sheet Hoja de sprites (generada con tools/img2c.py --format rgb565).
+ * @param sx Coordenada X del sprite dentro de la hoja.
+ * @param sy Coordenada Y del sprite dentro de la hoja.
+ * @param w Ancho del sprite en píxeles.
+ * @param h Alto del sprite en píxeles.
+ */
+void LCD_GFX_drawSprite(int16_t x, int16_t y, const bitmap_t *sheet, int16_t sx, int16_t sy, int16_t w, int16_t h);
+
 /**
  * @brief Dibuja el contorno de un círculo en la pantalla LCD.
  * 
@@ -133,6 +250,24 @@ void LCD_GFX_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color
  */
 void LCD_GFX_drawString(int16_t x, int16_t y, char* c, uint16_t color, uint16_t bg, uint8_t size);
 
+/**
+ * @brief Dibuja una cadena de texto girada un múltiplo de 90 grados respecto a la rotación actual.
+ * 
+ * Cada carácter se gira al leer la fuente, sin cambiar la rotación de la pantalla.
+ * Con orientación 1 el texto baja, con 2 va de derecha a izquierda y con 3 sube.
+ * Los saltos de línea ('\n') avanzan en la dirección perpendicular; no hay ajuste
+ * automático de línea.
+ * 
+ * @param x Coordenada X de la esquina superior izquierda del primer carácter ya girado.
+ * @param y Coordenada Y de la esquina superior izquierda del primer carácter ya girado.
+ * @param c Cadena a dibujar.
+ * @param color Color del texto.
+ * @param bg Color de fondo. Si es el mismo que el del texto no se dibuja fondo.
+ * @param size Tamaño de la fuente.
+ * @param orientation Giro en sentido horario, en pasos de 90 grados [0-3].
+ */
+void LCD_GFX_drawStringRotated(int16_t x, int16_t y, char* c, uint16_t color, uint16_t bg, uint8_t size, uint8_t orientation);
+
 /**
  * @brief Dibuja un píxel en la pantalla LCD.
  * 
@@ -142,6 +277,16 @@ void LCD_GFX_drawString(int16_t x, int16_t y, char* c, uint16_t color, uint16_t
  */
 void LCD_GFX_drawPixel(int16_t x, int16_t y, uint16_t color);
 
+/**
+ * @brief Envía a la pantalla los píxeles pendientes de LCD_GFX_drawPixel.
+ * 
+ * Los píxeles dibujados en orden de barrido se agrupan en ráfagas y no se
+ * muestran hasta que se rompe la secuencia o se llama a esta función. El resto
+ * de funciones de dibujo de este módulo la llaman al terminar. Con un framebuffer
+ * pasa sus píxeles sueltos a las zonas modificadas (LCD_Framebuffer_commit).
+ */
+void LCD_GFX_sync(void);
+
 /**
  * @brief Llena toda la pantalla LCD con un color sólido.
  * 
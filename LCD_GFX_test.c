@@ -17,7 +17,10 @@
  */
 #include "LCD_GFX_test.h"
 #include "LCD_GFX.h"
+#include "LCD_Framebuffer.h"
+#include "LCD_Dirty.h"
 #include "bitmaps.h"
+#include "nrf_delay.h"
 
 
 void LCD_GFX_test_circles(uint8_t radius, uint16_t color) {
@@ -106,7 +109,7 @@ void LCD_GFX_test_bitmap() {
     LCD_GFX_fillScreen(BLACK);
     char *text = "Mi cara XD";
 
-    LCD_GFX_drawBitmap(0, 0, foto, LCD_WIDTH, LCD_HEIGHT, WHITE);
+    LCD_GFX_drawBitmap(0, 0, bitmap_foto.data, bitmap_foto.width, bitmap_foto.height, WHITE);
     LCD_GFX_drawString(LCD_WIDTH >> 3, 20, text, MAGENTA, MAGENTA, 3);
 
 }
@@ -119,6 +122,126 @@ void LCD_GFX_test_rotation() {
     }
 }
 
+void LCD_GFX_test_rotatedText() {
+    LCD_GFX_setRotation(1);
+
+    // La foto vertical girada ocupa toda la pantalla apaisada, sin cambiar MADCTL
+    LCD_GFX_drawImageRotated(0, 0, &bitmap_foto, WHITE, BLACK, 1);
+
+    // Un texto en cada borde, leyendose desde fuera de la pantalla
+    LCD_GFX_drawStringRotated((LCD_WIDTH >> 1) - 36, 4, "ARRIBA", RED, BLACK, 2, 0);
+    LCD_GFX_drawStringRotated(LCD_WIDTH - 20, (LCD_HEIGHT >> 1) - 42, "DERECHA", GREEN, BLACK, 2, 1);
+    LCD_GFX_drawStringRotated((LCD_WIDTH >> 1) + 18, LCD_HEIGHT - 20, "ABAJO", BLUE, WHITE, 2, 2);
+    LCD_GFX_drawStringRotated(4, (LCD_HEIGHT >> 1) + 42, "IZQUIERDA", YELLOW, YELLOW, 2, 3);
+    LCD_GFX_setRotation(0);
+}
+
+void LCD_GFX_test_framebuffer() {
+    // Franja de 320x120 a 4 bits: 19200 bytes en lugar de 76800 en RGB565
+    static uint8_t buffer[LCD_FRAMEBUFFER_SIZE(LCD_FRAMEBUFFER_I4, 320, 120)];
+    static const uint16_t palette[4] = { BLACK, WHITE, RED, CYAN };
+    LCD_Framebuffer_t fb;
+
+    LCD_GFX_setRotation(1);
+    LCD_GFX_fillScreen(BLACK);
+    LCD_Framebuffer_init(&fb, buffer, LCD_FRAMEBUFFER_I4, 0, 60, 320, 120);
+    LCD_Framebuffer_setPalette(&fb, 0, palette, 4);
+
+    // Con el framebuffer seleccionado los colores son indices de la paleta
+    LCD_GFX_setFramebuffer(&fb);
+    LCD_GFX_fillCircle(60, 60, 40, 2);
+    LCD_GFX_drawRect(120, 20, 80, 80, 3);
+    LCD_GFX_drawLine(120, 20, 200, 100, 3);
+    LCD_GFX_drawImageRotated(220, 10, &bitmap_foto, 1, 0, 1);
+    LCD_GFX_drawString(10, 108, "Framebuffer I4", 1, 0, 1);
+    LCD_GFX_setFramebuffer(NULL);
+    LCD_Framebuffer_flush(&fb);
+
+    // Fundido a negro cambiando solo la paleta
+    for (uint8_t step = 1; step <= 8; step++) {
+        uint16_t faded[4];
+        for (uint8_t i = 0; i < 4; i++) {
+            uint16_t c = palette[i];
+            uint16_t r = ((c >> 11) & 0x1F) * (8 - step) / 8;
+            uint16_t g = ((c >> 5) & 0x3F) * (8 - step) / 8;
+            uint16_t b = (c & 0x1F) * (8 - step) / 8;
+            faded[i] = (r << 11) | (g << 5) | b;
+        }
+        LCD_Framebuffer_setPalette(&fb, 0, faded, 4);
+        LCD_Framebuffer_flush(&fb);
+        nrf_delay_ms(100);
+    }
+    LCD_GFX_setRotation(0);
+}
+
+void LCD_GFX_test_monoFramebuffer() {
+    // Pantalla apaisada completa a 1 bit: 9600 bytes
+    static uint32_t buffer[LCD_FRAMEBUFFER_SIZE(LCD_FRAMEBUFFER_MONO, 320, 240) / 4];
+    static const uint16_t palette[2] = { BLUE, WHITE };
+    LCD_Framebuffer_t fb;
+    char text[] = "Contador: 00";
+
+    LCD_GFX_setRotation(1);
+    LCD_Framebuffer_init(&fb, (uint8_t *)buffer, LCD_FRAMEBUFFER_MONO, 0, 0, 320, 240);
+    LCD_Framebuffer_setPalette(&fb, 0, palette, 2);
+
+    LCD_GFX_setFramebuffer(&fb);
+    LCD_GFX_drawRect(4, 4, 311, 231, 1);
+    LCD_GFX_drawString(20, 20, "Framebuffer de 1 bit", 1, 0, 2);
+    LCD_GFX_setFramebuffer(NULL);
+    LCD_Framebuffer_flush(&fb);
+
+    // Cada paso redibuja el contador y una aguja; solo se vuelca la zona modificada
+    for (uint8_t i = 0; i < 60; i++) {
+        text[10] = '0' + i / 10;
+        text[11] = '0' + i % 10;
+        LCD_GFX_setFramebuffer(&fb);
+        LCD_GFX_fillRect(60, 80, 200, 140, 0);
+        LCD_GFX_drawString(100, 90, text, 1, 0, 1);
+        LCD_GFX_drawLine(160, 150, 160 + (i % 15) * 6 - 42, 110 + (i / 15) * 20, 1);
+        LCD_GFX_setFramebuffer(NULL);
+        LCD_Framebuffer_flush(&fb);
+        nrf_delay_ms(50);
+    }
+    LCD_GFX_setRotation(0);
+}
+
+void LCD_GFX_test_dirty() {
+    // Tres cajas que se mueven; cada paso solo redibuja lo que ha cambiado
+    int16_t box[3][2] = { {10, 20}, {10, 100}, {10, 180} };
+    static const int8_t speed[3] = { 2, 3, 5 };
+    static const uint16_t color[3] = { RED, GREEN, YELLOW };
+    LCD_Dirty_t dirty;
+    LCD_Dirty_rect_t r;
+
+    LCD_GFX_setRotation(1);
+    LCD_GFX_fillScreen(BLACK);
+    LCD_Dirty_init(&dirty, LCD_WIDTH, LCD_HEIGHT, LCD_DIRTY_WINDOW_COST);
+
+    for (uint8_t step = 0; step < 80; step++) {
+        // Zona vieja y nueva de cada caja; si se solapan se unen en una sola ventana
+        for (uint8_t i = 0; i < 3; i++) {
+            LCD_Dirty_add(&dirty, box[i][0], box[i][1], 24, 24);
+            box[i][0] += speed[i];
+            LCD_Dirty_add(&dirty, box[i][0], box[i][1], 24, 24);
+        }
+
+        // Redibujar cada rectangulo: fondo y la parte de cada caja que cae dentro
+        while (LCD_Dirty_pop(&dirty, &r)) {
+            LCD_GFX_fillRect(r.x0, r.y0, r.x1 - r.x0 + 1, r.y1 - r.y0, BLACK);
+            for (uint8_t i = 0; i < 3; i++) {
+                int16_t x0 = box[i][0] > r.x0 ? box[i][0] : r.x0;
+                int16_t y0 = box[i][1] > r.y0 ? box[i][1] : r.y0;
+                int16_t x1 = box[i][0] + 23 < r.x1 ? box[i][0] + 23 : r.x1;
+                int16_t y1 = box[i][1] + 23 < r.y1 ? box[i][1] + 23 : r.y1;
+                if (x0 <= x1 && y0 <= y1) LCD_GFX_fillRect(x0, y0, x1 - x0 + 1, y1 - y0, color[i]);
+            }
+        }
+        nrf_delay_ms(20);
+    }
+    LCD_GFX_setRotation(0);
+}
+
 void LCD_GFX_test_shapes() {
     LCD_GFX_test_fillScreen();
     LCD_GFX_test_lines(CYAN);
@@ -137,5 +260,9 @@ void LCD_GFX_test_all() {
     LCD_GFX_test_circles(15, WHITE);
     LCD_GFX_test_bitmap();
     LCD_GFX_test_rotation();
+    LCD_GFX_test_rotatedText();
+    LCD_GFX_test_framebuffer();
+    LCD_GFX_test_monoFramebuffer();
+    LCD_GFX_test_dirty();
     LCD_GFX_test_text();
 }
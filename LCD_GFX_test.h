@@ -83,6 +83,26 @@ void LCD_GFX_test_bitmap(void);
  */
 void LCD_GFX_test_rotation(void);
 
+/**
+ * @brief Dibuja texto e imágenes en las cuatro orientaciones sin cambiar la rotación.
+ */
+void LCD_GFX_test_rotatedText(void);
+
+/**
+ * @brief Dibuja en un framebuffer de 4 bits, lo vuelca y lo funde a negro con la paleta.
+ */
+void LCD_GFX_test_framebuffer(void);
+
+/**
+ * @brief Actualiza sin parpadeo un contador en un framebuffer de 1 bit de toda la pantalla.
+ */
+void LCD_GFX_test_monoFramebuffer(void);
+
+/**
+ * @brief Mueve unas cajas redibujando solo las zonas que devuelve LCD_Dirty.
+ */
+void LCD_GFX_test_dirty(void);
+
 /**
  * @brief Ejecuta todos los test que generan formas secuencialmente. 
  */
@@ -0,0 +1,291 @@
+/**
+ * @file        LCD_Gesture.c
+ * @brief       Implementación del reconocedor de gestos sobre los eventos del táctil.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Máquina de estados con tres estados mientras el lápiz está apoyado:
+ *              PRESSED (aún puede ser un toque), DRAGGING y LONG_PRESSED. El toque
+ *              pendiente de un posible doble toque se guarda aparte, ya que sobrevive
+ *              al levantar el lápiz. La velocidad se estima con las últimas
+ *              LCD_GESTURE_WINDOW muestras.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Gesture.h
+ */
+#include <stddef.h>
+#include "LCD_Gesture.h"
+
+typedef enum {
+    STATE_IDLE,
+    STATE_PRESSED,
+    STATE_DRAGGING,
+    STATE_LONG_PRESSED
+} gesture_state_t;
+
+/**
+ * @brief Muestra guardada para estimar la velocidad.
+ */
+typedef struct {
+    uint16_t x, y;
+    uint32_t t;
+} gesture_sample_t;
+
+static LCD_Gesture_config_t config = LCD_GESTURE_CONFIG_DEFAULT;
+
+static struct {
+    gesture_state_t state;
+    uint16_t start_x, start_y;      // Donde se apoyó el lápiz
+    uint32_t start_t;
+    bool second_tap;                // El lápiz se apoyó dentro de la espera del doble toque
+    gesture_sample_t window[LCD_GESTURE_WINDOW];
+    uint8_t count;                  // Muestras validas en window
+    uint8_t next;                   // Siguiente posicion a escribir en window
+} gesture;
+
+// Toque a la espera de saber si es doble
+static struct {
+    bool pending;
+    uint16_t x, y;
+    uint32_t t;                     // Instante en el que se levantó el lápiz
+} tap;
+
+static struct {
+    LCD_Gesture_event_t events[LCD_GESTURE_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t tail;
+} queue;
+
+/**
+ * @brief Devuelve el cuadrado de la distancia entre dos puntos.
+ */
+static int32_t LCD_Gesture_dist2(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    int32_t dx = x1 - x0;
+    int32_t dy = y1 - y0;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief Guarda una muestra en la ventana de velocidad.
+ */
+static void LCD_Gesture_addSample(uint16_t x, uint16_t y, uint32_t t) {
+    gesture.window[gesture.next] = (gesture_sample_t){ x, y, t };
+    gesture.next = (gesture.next + 1) % LCD_GESTURE_WINDOW;
+    if (gesture.count < LCD_GESTURE_WINDOW) gesture.count++;
+}
+
+/**
+ * @brief Estima la velocidad entre la muestra más antigua y la más reciente de la ventana.
+ */
+static void LCD_Gesture_velocity(int16_t *vx, int16_t *vy) {
+    *vx = 0;
+    *vy = 0;
+    if (gesture.count < 2) return;
+
+    const gesture_sample_t *newest = &gesture.window[(gesture.next + LCD_GESTURE_WINDOW - 1) % LCD_GESTURE_WINDOW];
+    const gesture_sample_t *oldest = &gesture.window[(gesture.next + LCD_GESTURE_WINDOW - gesture.count) % LCD_GESTURE_WINDOW];
+    uint32_t dt = newest->t - oldest->t;
+    if (dt == 0) return;
+
+    int32_t v;
+    v = ((int32_t)newest->x - oldest->x) * 1000 / (int32_t)dt;
+    *vx = v > INT16_MAX ? INT16_MAX : (v < -INT16_MAX ? -INT16_MAX : v);
+    v = ((int32_t)newest->y - oldest->y) * 1000 / (int32_t)dt;
+    *vy = v > INT16_MAX ? INT16_MAX : (v < -INT16_MAX ? -INT16_MAX : v);
+}
+
+/**
+ * @brief Mete un gesto en la cola. Si está llena se descarta el más antiguo.
+ */
+static LCD_Gesture_event_t *LCD_Gesture_emit(LCD_Gesture_type_t type, uint16_t x, uint16_t y, uint32_t t) {
+    if ((uint8_t)(queue.head - queue.tail) == LCD_GESTURE_QUEUE_SIZE) queue.tail++;
+
+    LCD_Gesture_event_t *ev = &queue.events[queue.head & (LCD_GESTURE_QUEUE_SIZE - 1)];
+    ev->type = type;
+    ev->x = x;
+    ev->y = y;
+    ev->dx = (int16_t)x - (int16_t)gesture.start_x;
+    ev->dy = (int16_t)y - (int16_t)gesture.start_y;
+    LCD_Gesture_velocity(&ev->vx, &ev->vy);
+    if ((ev->dx < 0 ? -ev->dx : ev->dx) >= (ev->dy < 0 ? -ev->dy : ev->dy)) {
+        ev->direction = ev->dx < 0 ? LCD_GESTURE_LEFT : LCD_GESTURE_RIGHT;
+    }
+    else {
+        ev->direction = ev->dy < 0 ? LCD_GESTURE_UP : LCD_GESTURE_DOWN;
+    }
+    ev->timestamp = t;
+    queue.head++;
+    return ev;
+}
+
+/**
+ * @brief Emite el toque pendiente como toque simple.
+ */
+static void LCD_Gesture_flushTap(void) {
+    if (!tap.pending) return;
+    tap.pending = false;
+
+    // El toque no tiene desplazamiento ni velocidad
+    LCD_Gesture_event_t *ev = LCD_Gesture_emit(LCD_GESTURE_TAP, tap.x, tap.y, tap.t);
+    ev->dx = ev->dy = 0;
+    ev->vx = ev->vy = 0;
+}
+
+/**
+ * @brief El lápiz deja de poder formar un doble toque: el primer toque era simple.
+ */
+static void LCD_Gesture_cancelSecondTap(void) {
+    if (!gesture.second_tap) return;
+    gesture.second_tap = false;
+    tap.pending = true;
+    LCD_Gesture_flushTap();
+}
+
+void LCD_Gesture_init(const LCD_Gesture_config_t *cfg) {
+    static const LCD_Gesture_config_t defaults = LCD_GESTURE_CONFIG_DEFAULT;
+    config = cfg != NULL ? *cfg : defaults;
+    gesture.state = STATE_IDLE;
+    gesture.count = 0;
+    gesture.next = 0;
+    gesture.second_tap = false;
+    tap.pending = false;
+    queue.head = queue.tail = 0;
+}
+
+/**
+ * @brief El lápiz se ha apoyado.
+ */
+static void LCD_Gesture_down(const LCD_TouchScreen_event_t *ev) {
+    gesture.second_tap = false;
+    if (tap.pending) {
+        int32_t slop = config.double_tap_slop;
+        if (ev->timestamp - tap.t <= config.double_tap_ms &&
+            LCD_Gesture_dist2(tap.x, tap.y, ev->x, ev->y) <= slop * slop) {
+            // Se guarda el toque por si el segundo no llega a ser un toque
+            gesture.second_tap = true;
+            tap.pending = false;
+        }
+        else {
+            LCD_Gesture_flushTap();
+        }
+    }
+
+    gesture.state = STATE_PRESSED;
+    gesture.start_x = ev->x;
+    gesture.start_y = ev->y;
+    gesture.start_t = ev->timestamp;
+    gesture.count = 0;
+    gesture.next = 0;
+    LCD_Gesture_addSample(ev->x, ev->y, ev->timestamp);
+}
+
+/**
+ * @brief Nueva muestra con el lápiz apoyado.
+ */
+static void LCD_Gesture_move(const LCD_TouchScreen_event_t *ev) {
+    int32_t slop = config.tap_slop;
+
+    LCD_Gesture_addSample(ev->x, ev->y, ev->timestamp);
+    switch (gesture.state) {
+        case STATE_PRESSED:
+            if (LCD_Gesture_dist2(gesture.start_x, gesture.start_y, ev->x, ev->y) > slop * slop) {
+                LCD_Gesture_cancelSecondTap();
+                gesture.state = STATE_DRAGGING;
+                LCD_Gesture_emit(LCD_GESTURE_DRAG_START, ev->x, ev->y, ev->timestamp);
+            }
+            else {
+                LCD_Gesture_poll(ev->timestamp);
+            }
+            break;
+        case STATE_DRAGGING:
+            LCD_Gesture_emit(LCD_GESTURE_DRAG, ev->x, ev->y, ev->timestamp);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief El lápiz se ha levantado.
+ */
+static void LCD_Gesture_up(const LCD_TouchScreen_event_t *ev) {
+    // El UP repite la posicion de la ultima muestra, no se usa para la velocidad
+    switch (gesture.state) {
+        case STATE_PRESSED:
+            if (ev->timestamp - gesture.start_t > config.tap_max_ms) {
+                LCD_Gesture_cancelSecondTap();
+            }
+            else if (gesture.second_tap) {
+                gesture.second_tap = false;
+                LCD_Gesture_emit(LCD_GESTURE_DOUBLE_TAP, gesture.start_x, gesture.start_y, ev->timestamp);
+            }
+            else {
+                // Toque simple, salvo que llegue otro antes de double_tap_ms
+                tap.pending = true;
+                tap.x = gesture.start_x;
+                tap.y = gesture.start_y;
+                tap.t = ev->timestamp;
+                if (config.double_tap_ms == 0) LCD_Gesture_flushTap();
+            }
+            break;
+        case STATE_DRAGGING: {
+            int16_t vx, vy;
+            LCD_Gesture_velocity(&vx, &vy);
+            int32_t speed2 = (int32_t)vx * vx + (int32_t)vy * vy;
+            int32_t fling = config.fling_min_velocity;
+            int32_t swipe = config.swipe_min_velocity;
+            int32_t distance = config.swipe_min_distance;
+
+            LCD_Gesture_emit(LCD_GESTURE_DRAG_END, ev->x, ev->y, ev->timestamp);
+            if (speed2 >= fling * fling) {
+                LCD_Gesture_emit(LCD_GESTURE_FLING, ev->x, ev->y, ev->timestamp);
+            }
+            else if (speed2 >= swipe * swipe &&
+                     LCD_Gesture_dist2(gesture.start_x, gesture.start_y, ev->x, ev->y) >= distance * distance) {
+                LCD_Gesture_emit(LCD_GESTURE_SWIPE, ev->x, ev->y, ev->timestamp);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    gesture.state = STATE_IDLE;
+}
+
+void LCD_Gesture_feed(const LCD_TouchScreen_event_t *ev) {
+    switch (ev->type) {
+        case LCD_TOUCH_DOWN:
+            LCD_Gesture_down(ev);
+            break;
+        case LCD_TOUCH_MOVE:
+            // Si se perdio el DOWN (cola llena) la primera muestra hace de DOWN
+            if (gesture.state == STATE_IDLE) LCD_Gesture_down(ev);
+            else LCD_Gesture_move(ev);
+            break;
+        case LCD_TOUCH_UP:
+            if (gesture.state != STATE_IDLE) LCD_Gesture_up(ev);
+            break;
+    }
+}
+
+void LCD_Gesture_poll(uint32_t now) {
+    if (gesture.state == STATE_PRESSED && now - gesture.start_t >= config.long_press_ms) {
+        const gesture_sample_t *last = &gesture.window[(gesture.next + LCD_GESTURE_WINDOW - 1) % LCD_GESTURE_WINDOW];
+        LCD_Gesture_cancelSecondTap();
+        gesture.state = STATE_LONG_PRESSED;
+        LCD_Gesture_emit(LCD_GESTURE_LONG_PRESS, last->x, last->y, now);
+    }
+    if (tap.pending && now - tap.t > config.double_tap_ms) {
+        LCD_Gesture_flushTap();
+    }
+}
+
+bool LCD_Gesture_getEvent(LCD_Gesture_event_t *event) {
+    if (queue.head == queue.tail) return false;
+    *event = queue.events[queue.tail & (LCD_GESTURE_QUEUE_SIZE - 1)];
+    queue.tail++;
+    return true;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file        LCD_Gesture.h
+ * @brief       Cabeceras del reconocedor de gestos sobre los eventos del táctil.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Convierte la secuencia de eventos de LCD_TouchScreen (DOWN, MOVE, UP) en
+ *              gestos: toque, doble toque, pulsación larga, arrastre, deslizamiento
+ *              (swipe) y lanzamiento (fling), con una estimación de la velocidad.
+ *              Se alimenta muestra a muestra y solo guarda las últimas muestras
+ *              necesarias para la velocidad. Los gestos que dependen del tiempo
+ *              (pulsación larga, toque simple tras la espera del doble toque) se
+ *              detectan también llamando a LCD_Gesture_poll.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Gesture.c, LCD_TouchScreen.h
+ */
+
+#ifndef LCD_GESTURE_H
+#define LCD_GESTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LCD_TouchScreen.h"
+
+// Numero de muestras usadas para estimar la velocidad
+#define LCD_GESTURE_WINDOW 4
+
+// Capacidad de la cola de gestos (potencia de 2)
+#define LCD_GESTURE_QUEUE_SIZE 16
+
+/**
+ * @brief Tipo de gesto.
+ */
+typedef enum {
+    LCD_GESTURE_TAP,            // Toque corto sin moverse
+    LCD_GESTURE_DOUBLE_TAP,     // Dos toques seguidos en el mismo sitio
+    LCD_GESTURE_LONG_PRESS,     // Lápiz apoyado sin moverse durante long_press_ms
+    LCD_GESTURE_DRAG_START,     // El lápiz se ha movido más de tap_slop
+    LCD_GESTURE_DRAG,           // Nueva posición durante el arrastre
+    LCD_GESTURE_DRAG_END,       // Se ha levantado el lápiz tras un arrastre
+    LCD_GESTURE_SWIPE,          // Arrastre largo y rápido, tras DRAG_END
+    LCD_GESTURE_FLING           // Arrastre muy rápido, tras DRAG_END
+} LCD_Gesture_type_t;
+
+/**
+ * @brief Dirección dominante de un deslizamiento, en coordenadas de pantalla.
+ */
+typedef enum {
+    LCD_GESTURE_LEFT,
+    LCD_GESTURE_RIGHT,
+    LCD_GESTURE_UP,
+    LCD_GESTURE_DOWN
+} LCD_Gesture_direction_t;
+
+/**
+ * @brief Gesto reconocido.
+ */
+typedef struct {
+    LCD_Gesture_type_t type;
+    uint16_t x;                         // Posición actual en píxeles
+    uint16_t y;
+    int16_t dx;                         // Desplazamiento desde que se apoyó el lápiz
+    int16_t dy;
+    int16_t vx;                         // Velocidad en píxeles/s
+    int16_t vy;
+    LCD_Gesture_direction_t direction;  // Dirección dominante de (dx, dy)
+    uint32_t timestamp;                 // Instante en ms
+} LCD_Gesture_event_t;
+
+/**
+ * @brief Umbrales del reconocedor, en píxeles y milisegundos.
+ */
+typedef struct {
+    uint16_t tap_slop;              // Movimiento máximo de un toque o pulsación larga
+    uint16_t tap_max_ms;            // Duración máxima de un toque
+    uint16_t double_tap_ms;         // Espera máxima entre dos toques (0 = sin doble toque)
+    uint16_t double_tap_slop;       // Distancia máxima entre los dos toques
+    uint16_t long_press_ms;         // Duración de la pulsación larga
+    uint16_t swipe_min_distance;    // Desplazamiento mínimo de un swipe
+    uint16_t swipe_min_velocity;    // Velocidad mínima de un swipe, en píxeles/s
+    uint16_t fling_min_velocity;    // Velocidad mínima de un fling, en píxeles/s
+} LCD_Gesture_config_t;
+
+#define LCD_GESTURE_CONFIG_DEFAULT { \
+    .tap_slop = 10,                  \
+    .tap_max_ms = 250,               \
+    .double_tap_ms = 300,            \
+    .double_tap_slop = 30,           \
+    .long_press_ms = 600,            \
+    .swipe_min_distance = 50,        \
+    .swipe_min_velocity = 200,       \
+    .fling_min_velocity = 1000       \
+}
+
+/**
+ * @brief Inicializa el reconocedor.
+ * @param config Umbrales a usar, o NULL para LCD_GESTURE_CONFIG_DEFAULT.
+ */
+void LCD_Gesture_init(const LCD_Gesture_config_t *config);
+
+/**
+ * @brief Procesa un evento del táctil.
+ *
+ * Los gestos reconocidos se obtienen después con LCD_Gesture_getEvent.
+ *
+ * @param event Evento obtenido con LCD_TouchScreen_getEvent.
+ */
+void LCD_Gesture_feed(const LCD_TouchScreen_event_t *event);
+
+/**
+ * @brief Comprueba los gestos que dependen del tiempo sin que lleguen muestras.
+ *
+ * Detecta la pulsación larga aunque el muestreo no genere eventos y emite el
+ * toque simple cuando vence la espera del doble toque.
+ *
+ * @param now Instante actual en ms, en la misma base que los eventos
+ *            (ver LCD_TouchScreen_millis).
+ */
+void LCD_Gesture_poll(uint32_t now);
+
+/**
+ * @brief Saca el siguiente gesto reconocido.
+ * @param event Puntero donde se copia el gesto.
+ * @return true si había algún gesto, false si no.
+ */
+bool LCD_Gesture_getEvent(LCD_Gesture_event_t *event);
+
+#endif
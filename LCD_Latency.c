@@ -0,0 +1,147 @@
+/**
+ * @file        LCD_Latency.c
+ * @brief       Implementación de la instrumentación de latencia táctil-pantalla.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Las marcas son lecturas de DWT->CYCCNT (64 MHz, da la vuelta cada 67 s),
+ *              por lo que las diferencias se calculan sin signo y solo son válidas
+ *              para intervalos menores que una vuelta. Los tramos FILTER se registran
+ *              desde la interrupción del muestreo y el resto desde la aplicación; cada
+ *              histograma solo se actualiza desde uno de los dos contextos.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Latency.h
+ */
+#include "LCD_Latency.h"
+
+#if LCD_LATENCY_ENABLED
+
+#include <stdbool.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_log.h"
+
+/**
+ * @brief Histograma de un tramo, en µs.
+ */
+typedef struct {
+    uint32_t buckets[LCD_LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} latency_histogram_t;
+
+static const char *stage_names[LCD_LATENCY_STAGES] = {
+    "filtrado", "cola", "dibujo", "total"
+};
+
+static latency_histogram_t histograms[LCD_LATENCY_STAGES];
+
+static volatile uint32_t sample_stamp;      // Ultima lectura SPI del tactil
+static volatile uint32_t pixels_stamp;      // Ultima transferencia SPI de pixeles
+
+// Dibujo en curso
+static struct {
+    bool active;
+    uint32_t sample;
+    uint32_t start;
+} draw;
+
+static inline uint32_t LCD_Latency_now(void) {
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Añade un intervalo en ciclos al histograma de un tramo.
+ */
+static void LCD_Latency_record(LCD_Latency_stage_t stage, uint32_t cycles) {
+    latency_histogram_t *h = &histograms[stage];
+    uint32_t us = cycles / (SystemCoreClock / 1000000);
+
+    // Cubeta k: [2^k, 2^(k+1)) µs, la 0 incluye tambien el 0
+    uint8_t bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+    if (bucket >= LCD_LATENCY_BUCKETS) bucket = LCD_LATENCY_BUCKETS - 1;
+
+    h->buckets[bucket]++;
+    if (h->count == 0 || us < h->min) h->min = us;
+    if (us > h->max) h->max = us;
+    h->sum += us;
+    h->count++;
+}
+
+void LCD_Latency_reset(void) {
+    memset(histograms, 0, sizeof(histograms));
+    draw.active = false;
+}
+
+void LCD_Latency_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    LCD_Latency_reset();
+}
+
+void LCD_Latency_markSample(void) {
+    sample_stamp = LCD_Latency_now();
+}
+
+void LCD_Latency_markEvent(uint32_t *sample, uint32_t *event) {
+    uint32_t now = LCD_Latency_now();
+    *sample = sample_stamp;
+    *event = now;
+    LCD_Latency_record(LCD_LATENCY_FILTER, now - *sample);
+}
+
+void LCD_Latency_markPixels(void) {
+    pixels_stamp = LCD_Latency_now();
+}
+
+void LCD_Latency_beginDraw(uint32_t sample, uint32_t event) {
+    uint32_t now = LCD_Latency_now();
+    LCD_Latency_record(LCD_LATENCY_QUEUE, now - event);
+    draw.active = true;
+    draw.sample = sample;
+    draw.start = now;
+}
+
+void LCD_Latency_endDraw(void) {
+    if (!draw.active) return;
+    draw.active = false;
+
+    // Si el dibujo no ha enviado pixeles no hay nada que medir
+    uint32_t pixels = pixels_stamp;
+    if ((int32_t)(pixels - draw.start) <= 0) return;
+
+    LCD_Latency_record(LCD_LATENCY_RENDER, pixels - draw.start);
+    LCD_Latency_record(LCD_LATENCY_TOTAL, pixels - draw.sample);
+}
+
+void LCD_Latency_report(void) {
+    for (uint8_t s = 0; s < LCD_LATENCY_STAGES; s++) {
+        const latency_histogram_t *h = &histograms[s];
+        if (h->count == 0) {
+            NRF_LOG_INFO("%s: sin muestras", stage_names[s]);
+            continue;
+        }
+
+        NRF_LOG_INFO("%s: n=%u min=%u max=%u media=%u us", stage_names[s],
+                     h->count, h->min, h->max, (uint32_t)(h->sum / h->count));
+        for (uint8_t b = 0; b < LCD_LATENCY_BUCKETS; b++) {
+            if (h->buckets[b] == 0) continue;
+            if (b == LCD_LATENCY_BUCKETS - 1) {
+                NRF_LOG_INFO("  >= %u us: %u", 1u << b, h->buckets[b]);
+            }
+            else {
+                NRF_LOG_INFO("  [%u, %u) us: %u", b == 0 ? 0 : 1u << b, 2u << b, h->buckets[b]);
+            }
+        }
+        NRF_LOG_FLUSH();
+    }
+}
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file        LCD_Latency.h
+ * @brief       Cabeceras de la instrumentación de latencia táctil-pantalla.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Marca con el contador de ciclos (DWT->CYCCNT) cuatro puntos del camino
+ *              de cada muestra táctil:
+ *                  - SAMPLE: fin de la lectura SPI en XPT2046_readData.
+ *                  - EVENT:  evento calibrado y filtrado metido en la cola.
+ *                  - DRAW:   la aplicación empieza a dibujar a partir del evento.
+ *                  - PIXELS: fin de la última transferencia SPI de píxeles del dibujo.
+ *              Con ellas se rellenan histogramas logarítmicos (potencias de 2 en µs)
+ *              de cada tramo y del total, que se envían por NRF_LOG con
+ *              LCD_Latency_report. Permite ver si el retraso viene del muestreo y
+ *              filtrado, de la espera en la cola o del dibujo.
+ *
+ *              Se compila solo con LCD_LATENCY_ENABLED a 1; si no, las macros
+ *              LCD_LATENCY_* no generan código.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Latency.c
+ */
+
+#ifndef LCD_LATENCY_H
+#define LCD_LATENCY_H
+
+#include <stdint.h>
+
+#ifndef LCD_LATENCY_ENABLED
+#define LCD_LATENCY_ENABLED 0
+#endif
+
+// Numero de cubetas de los histogramas: [0, 2), [2, 4), ... [2^15, inf) µs
+#define LCD_LATENCY_BUCKETS 16
+
+/**
+ * @brief Tramos medidos.
+ */
+typedef enum {
+    LCD_LATENCY_FILTER,     // SAMPLE -> EVENT: lectura, filtrado y calibración
+    LCD_LATENCY_QUEUE,      // EVENT -> DRAW: espera en la cola hasta que la aplicación lo lee
+    LCD_LATENCY_RENDER,     // DRAW -> PIXELS: dibujo y envío por SPI
+    LCD_LATENCY_TOTAL,      // SAMPLE -> PIXELS
+    LCD_LATENCY_STAGES
+} LCD_Latency_stage_t;
+
+#if LCD_LATENCY_ENABLED
+
+/**
+ * @brief Arranca el contador de ciclos y borra los histogramas.
+ */
+void LCD_Latency_init(void);
+
+/**
+ * @brief Marca el fin de una lectura SPI del táctil.
+ */
+void LCD_Latency_markSample(void);
+
+/**
+ * @brief Marca un evento metido en la cola.
+ * @param sample Devuelve el instante de la muestra del evento, para guardarlo con él.
+ * @param event Devuelve el instante del evento.
+ */
+void LCD_Latency_markEvent(uint32_t *sample, uint32_t *event);
+
+/**
+ * @brief Marca el fin de una transferencia SPI de píxeles.
+ */
+void LCD_Latency_markPixels(void);
+
+/**
+ * @brief La aplicación empieza a dibujar a partir de un evento.
+ * @param sample Instante de la muestra guardado en el evento.
+ * @param event Instante del evento guardado en el evento.
+ */
+void LCD_Latency_beginDraw(uint32_t sample, uint32_t event);
+
+/**
+ * @brief La aplicación ha terminado de dibujar el evento.
+ */
+void LCD_Latency_endDraw(void);
+
+/**
+ * @brief Envía los histogramas por NRF_LOG.
+ * @note NRF_LOG debe estar inicializado.
+ */
+void LCD_Latency_report(void);
+
+/**
+ * @brief Borra los histogramas.
+ */
+void LCD_Latency_reset(void);
+
+#define LCD_LATENCY_INIT()          LCD_Latency_init()
+#define LCD_LATENCY_SAMPLE()        LCD_Latency_markSample()
+#define LCD_LATENCY_EVENT(ev)       LCD_Latency_markEvent(&(ev)->latency_sample, &(ev)->latency_event)
+#define LCD_LATENCY_PIXELS()        LCD_Latency_markPixels()
+#define LCD_LATENCY_DRAW_BEGIN(ev)  LCD_Latency_beginDraw((ev)->latency_sample, (ev)->latency_event)
+#define LCD_LATENCY_DRAW_END()      LCD_Latency_endDraw()
+#define LCD_LATENCY_REPORT()        LCD_Latency_report()
+
+#else
+
+#define LCD_LATENCY_INIT()
+#define LCD_LATENCY_SAMPLE()
+#define LCD_LATENCY_EVENT(ev)
+#define LCD_LATENCY_PIXELS()
+#define LCD_LATENCY_DRAW_BEGIN(ev)
+#define LCD_LATENCY_DRAW_END()
+#define LCD_LATENCY_REPORT()
+
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file        LCD_Pipeline.c
+ * @brief       Implementación del envío en paralelo de filas a la pantalla.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Los buffers forman una cola circular: [tail, tail + pending) están en
+ *              cola o enviándose y `head` es el siguiente que rellena la CPU. El
+ *              primero de la cola se envía con ILI9341_pushPixelsAsync; su aviso, desde
+ *              la interrupción del SPIM, lo libera y lanza el siguiente, de forma que
+ *              el bus no se para mientras haya algo en cola. Solo el programa
+ *              principal añade a la cola y solo la interrupción la vacía.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Pipeline.h
+ */
+#include <string.h>
+#include "nrf.h"
+#include "LCD_Pipeline.h"
+#include "ILI9341.h"
+
+static uint32_t buffers[LCD_PIPELINE_BUFFERS][(LCD_PIPELINE_BUFFER_SIZE + 3) / 4];
+
+// Datos en cola de cada buffer
+static const uint8_t *queue_data[LCD_PIPELINE_BUFFERS];
+static uint32_t queue_len[LCD_PIPELINE_BUFFERS];
+
+static uint8_t head = 0;                // Siguiente buffer que rellena la CPU
+static volatile uint8_t tail = 0;       // Buffer que se esta enviando
+static volatile uint8_t pending = 0;    // Buffers en cola, incluido el que se envia
+static volatile bool sending = false;
+static bool started = false;            // Ya se ha enviado algo de la ventana actual
+static volatile uint32_t idle_since;    // Instante en el que el bus se quedo sin nada en cola
+
+static LCD_Pipeline_stats_t stats;
+
+static inline uint32_t LCD_Pipeline_now(void) {
+    return DWT->CYCCNT;
+}
+
+static void LCD_Pipeline_start(void);
+
+/**
+ * @brief Fin del envio del primer buffer de la cola, desde la interrupcion del SPIM.
+ */
+static void LCD_Pipeline_done(void *context) {
+    tail = (tail + 1) % LCD_PIPELINE_BUFFERS;
+    pending--;
+    if (pending > 0) {
+        LCD_Pipeline_start();
+    }
+    else {
+        idle_since = LCD_Pipeline_now();
+        sending = false;
+    }
+}
+
+/**
+ * @brief Envia el primer buffer de la cola.
+ */
+static void LCD_Pipeline_start(void) {
+    ILI9341_pushPixelsAsync(queue_data[tail], queue_len[tail], LCD_Pipeline_done, NULL);
+}
+
+void LCD_Pipeline_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    LCD_Pipeline_resetStats();
+}
+
+void LCD_Pipeline_begin(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    LCD_Pipeline_end();
+    ILI9341_setWindow(x0, y0, x1, y1);
+    started = false;
+    stats.windows++;
+}
+
+uint8_t *LCD_Pipeline_getBuffer(void) {
+    if (pending == LCD_PIPELINE_BUFFERS) {
+        uint32_t start = LCD_Pipeline_now();
+        stats.stalls++;
+        while (pending == LCD_PIPELINE_BUFFERS) {}
+        stats.stall_cycles += LCD_Pipeline_now() - start;
+    }
+    return (uint8_t *)buffers[head];
+}
+
+void LCD_Pipeline_submit(const uint8_t *data, uint32_t len) {
+    queue_data[head] = data;
+    queue_len[head] = len;
+    head = (head + 1) % LCD_PIPELINE_BUFFERS;
+    stats.buffers++;
+    stats.bytes += len;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    pending++;
+    bool idle = !sending;
+    if (idle) sending = true;
+    __set_PRIMASK(primask);
+
+    if (!idle) return;
+
+    // El bus estaba parado: si ya se habia enviado algo de la ventana, esperaba a la CPU
+    if (started) {
+        stats.starves++;
+        stats.starve_cycles += LCD_Pipeline_now() - idle_since;
+    }
+    started = true;
+    LCD_Pipeline_start();
+}
+
+void LCD_Pipeline_end(void) {
+    while (sending) {}
+}
+
+void LCD_Pipeline_getStats(LCD_Pipeline_stats_t *out) {
+    *out = stats;
+}
+
+void LCD_Pipeline_resetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,108 @@
+/**
+ * @file        LCD_Pipeline.h
+ * @brief       Cabeceras del envío en paralelo de filas a la pantalla (dibujar mientras se transmite).
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Con envíos bloqueantes la CPU prepara una fila (expande bits, traduce
+ *              una paleta, descomprime) y luego espera a que salga por SPI, una cosa
+ *              detrás de otra. El pipeline tiene LCD_PIPELINE_BUFFERS buffers de fila:
+ *              mientras el SPIM envía uno por DMA, la CPU rellena el siguiente. Para
+ *              una ventana se llama a LCD_Pipeline_begin, y por cada fila a
+ *              LCD_Pipeline_getBuffer, que devuelve un buffer libre, y a
+ *              LCD_Pipeline_submit, que lo pone en cola para enviarlo.
+ *              LCD_Pipeline_end espera a que salga todo.
+ *
+ *              Las estadísticas dicen cuál de las dos partes limita: las esperas en
+ *              LCD_Pipeline_getBuffer (todos los buffers en cola) indican que manda
+ *              el bus, y los parones del bus sin nada en cola indican que manda la CPU.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Pipeline.c, ILI9341.h, LCD_SPI.h
+ */
+
+#ifndef LCD_PIPELINE_H
+#define LCD_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Buffers de fila (al menos 2: uno enviandose y otro rellenandose)
+#ifndef LCD_PIPELINE_BUFFERS
+#define LCD_PIPELINE_BUFFERS 2
+#endif
+
+// Bytes de cada buffer: una fila de 320 pixeles mas 8 de margen, para expandir
+// imagenes de 1 bit por pixel desde el principio del byte de la primera columna
+#ifndef LCD_PIPELINE_BUFFER_SIZE
+#define LCD_PIPELINE_BUFFER_SIZE (2 * (320 + 8))
+#endif
+
+#if LCD_PIPELINE_BUFFERS < 2
+#error "LCD_PIPELINE_BUFFERS debe ser al menos 2"
+#endif
+
+/**
+ * @brief Estadísticas acumuladas desde LCD_Pipeline_resetStats.
+ *
+ * Los tiempos se miden en ciclos de CPU (DWT->CYCCNT).
+ */
+typedef struct {
+    uint32_t windows;           // Ventanas enviadas
+    uint32_t buffers;           // Buffers enviados
+    uint32_t bytes;             // Bytes de pixeles enviados
+    uint32_t stalls;            // Veces que la CPU esperó un buffer libre (limita el bus)
+    uint32_t stall_cycles;      // Ciclos de CPU perdidos en esas esperas
+    uint32_t starves;           // Veces que el bus se paró sin nada en cola (limita la CPU)
+    uint32_t starve_cycles;     // Ciclos que el bus estuvo parado dentro de una ventana
+} LCD_Pipeline_stats_t;
+
+/**
+ * @brief Arranca el contador de ciclos y borra las estadísticas.
+ */
+void LCD_Pipeline_init(void);
+
+/**
+ * @brief Abre una ventana en la pantalla seleccionada (ver ILI9341_setWindow).
+ *
+ * Espera antes a que termine la ventana anterior.
+ */
+void LCD_Pipeline_begin(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+/**
+ * @brief Devuelve el siguiente buffer libre, esperando si todos están en cola.
+ *
+ * @return Buffer de LCD_PIPELINE_BUFFER_SIZE bytes alineado a 4 bytes.
+ */
+uint8_t *LCD_Pipeline_getBuffer(void);
+
+/**
+ * @brief Pone en cola los píxeles del buffer obtenido con LCD_Pipeline_getBuffer.
+ *
+ * @param data Primer byte a enviar, dentro de ese buffer.
+ * @param len Número de bytes a enviar (dos por píxel).
+ */
+void LCD_Pipeline_submit(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Espera a que se envíen todos los buffers en cola.
+ *
+ * Hasta entonces no se debe usar la pantalla de otra forma: lo que quede en cola
+ * se enviaría después.
+ */
+void LCD_Pipeline_end(void);
+
+/**
+ * @brief Copia las estadísticas acumuladas.
+ */
+void LCD_Pipeline_getStats(LCD_Pipeline_stats_t *stats);
+
+/**
+ * @brief Borra las estadísticas.
+ */
+void LCD_Pipeline_resetStats(void);
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * @file        LCD_SPI.c
+ * @brief       Implementación del bus SPI compartido por la pantalla (ILI9341) y el táctil (XPT2046).
+ * 
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ * 
+ * @details     Se usa el periférico SPIM, que envía con EasyDMA. Las transferencias
+ *              bloqueantes se lanzan sin interrupción y se espera al evento END, de
+ *              forma que pueden hacerse también desde interrupciones de cualquier
+ *              prioridad. Las asíncronas activan la interrupción del SPIM, que avisa
+ *              al terminar. EasyDMA solo lee de RAM: los datos en flash (imágenes
+ *              constantes) se copian antes por trozos a un buffer intermedio.
+ * 
+ *              Una serie de envíos asíncronos seguidos tendría el bus ocupado durante
+ *              toda una ventana. Las interrupciones que lo encuentran así aplazan su
+ *              trabajo con LCD_SPI_defer, que se atiende al liberar el bus entre dos
+ *              envíos.
+ * 
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025, 
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_SPI.h
+ */
+#include <string.h>
+#include "nrf.h"
+#include "nrfx_spim.h"
+#include "LCD_SPI.h"
+#include "LCD_pinout.h"
+
+#define SPI_INSTANCE 0
+static const nrfx_spim_t spi = NRFX_SPIM_INSTANCE(SPI_INSTANCE);
+
+// Buffer intermedio para enviar datos que estan en flash
+#define BOUNCE_SIZE 256
+static uint8_t bounce[BOUNCE_SIZE];
+
+static bool initialized = false;
+static volatile bool busy = false;
+static LCD_SPI_frequency_t current_frequency = LCD_SPI_FREQ_4M;
+
+// Aviso de la transferencia asincrona en curso
+static LCD_SPI_handler_t async_handler = NULL;
+static void *async_context;
+
+// El bus lo tiene una transferencia asincrona (hasta que se libera tras su aviso)
+static volatile bool background = false;
+
+// Trabajo aplazado con LCD_SPI_defer
+static volatile LCD_SPI_handler_t deferred_handler = NULL;
+static void *deferred_context;
+
+static const nrf_spim_frequency_t frequencies[] = {
+    [LCD_SPI_FREQ_1M] = NRF_SPIM_FREQ_1M,
+    [LCD_SPI_FREQ_2M] = NRF_SPIM_FREQ_2M,
+    [LCD_SPI_FREQ_4M] = NRF_SPIM_FREQ_4M,
+    [LCD_SPI_FREQ_8M] = NRF_SPIM_FREQ_8M
+};
+
+/**
+ * @brief Interrupcion del SPIM. Solo llega al terminar las transferencias asincronas.
+ */
+static void LCD_SPI_eventHandler(nrfx_spim_evt_t const *event, void *context) {
+    if (event->type != NRFX_SPIM_EVENT_DONE || async_handler == NULL) return;
+
+    // nrfx deja activada la interrupcion de END. Si siguiera activa, una transferencia
+    // bloqueante interrumpida justo tras START veria como la interrupcion borra el
+    // evento que espera y se quedaria colgada
+    nrf_spim_int_disable(spi.p_reg, NRF_SPIM_INT_END_MASK);
+
+    LCD_SPI_handler_t handler = async_handler;
+    async_handler = NULL;
+    handler(async_context);
+}
+
+/**
+ * @brief Transferencia bloqueante desde RAM, esperando al evento END sin interrupcion.
+ */
+static void LCD_SPI_xferRam(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len) {
+    nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_TRX(tx, tx_len, rx, rx_len);
+    nrfx_spim_xfer(&spi, &xfer, NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER);
+    while (!nrf_spim_event_check(spi.p_reg, NRF_SPIM_EVENT_END)) {}
+    nrf_spim_event_clear(spi.p_reg, NRF_SPIM_EVENT_END);
+}
+
+void LCD_SPI_init(void) {
+    if (initialized) return;
+
+    nrfx_spim_config_t spi_config = NRFX_SPIM_DEFAULT_CONFIG;
+    spi_config.sck_pin  = SPI_SCK_PIN;
+    spi_config.mosi_pin = SPI_MOSI_PIN;
+    spi_config.miso_pin = SPI_MISO_PIN;
+    spi_config.ss_pin   = NRFX_SPIM_PIN_NOT_USED;
+    spi_config.frequency = frequencies[current_frequency];
+    spi_config.mode = NRF_SPIM_MODE_0;
+    spi_config.bit_order = NRF_SPIM_BIT_ORDER_MSB_FIRST;
+
+    nrfx_spim_init(&spi, &spi_config, LCD_SPI_eventHandler, NULL);
+    initialized = true;
+}
+
+void LCD_SPI_acquire(void) {
+    for (;;) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool free = !busy;
+        if (free) busy = true;
+        __set_PRIMASK(primask);
+        if (free) return;
+    }
+}
+
+void LCD_SPI_release(void) {
+    busy = false;
+
+    // Fin de una transferencia asincrona: antes de lanzar la siguiente se atiende a
+    // quien encontro el bus ocupado. Solo ocurre desde el aviso, en la interrupcion
+    // del SPIM
+    if (!background) return;
+    background = false;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    LCD_SPI_handler_t handler = deferred_handler;
+    deferred_handler = NULL;
+    __set_PRIMASK(primask);
+
+    if (handler != NULL) handler(deferred_context);
+}
+
+bool LCD_SPI_defer(LCD_SPI_handler_t handler, void *context) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    bool deferred = background;
+    if (deferred) {
+        deferred_handler = handler;
+        deferred_context = context;
+    }
+    __set_PRIMASK(primask);
+    return deferred;
+}
+
+void LCD_SPI_cancelDefer(LCD_SPI_handler_t handler) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (deferred_handler == handler) deferred_handler = NULL;
+    __set_PRIMASK(primask);
+}
+
+bool LCD_SPI_isBusy(void) {
+    return busy;
+}
+
+void LCD_SPI_setFrequency(LCD_SPI_frequency_t frequency) {
+    if (frequency == current_frequency) return;
+    // Solo se lee al empezar cada transferencia, puede cambiarse con el periferico habilitado
+    nrf_spim_frequency_set(spi.p_reg, frequencies[frequency]);
+    current_frequency = frequency;
+}
+
+void LCD_SPI_xfer(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len) {
+    if (tx_len == 0 || nrfx_is_in_ram(tx)) {
+        LCD_SPI_xferRam(tx, tx_len, rx, rx_len);
+        return;
+    }
+
+    // Desde flash, por trozos a traves del buffer intermedio
+    while (tx_len > 0) {
+        size_t n = tx_len < BOUNCE_SIZE ? tx_len : BOUNCE_SIZE;
+        memcpy(bounce, tx, n);
+        LCD_SPI_xferRam(bounce, n, NULL, 0);
+        tx += n;
+        tx_len -= n;
+    }
+}
+
+void LCD_SPI_xferAsync(const uint8_t *tx, size_t tx_len, LCD_SPI_handler_t handler, void *context) {
+    nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_TX(tx, tx_len);
+    async_handler = handler;
+    async_context = context;
+    background = true;
+    nrfx_spim_xfer(&spi, &xfer, 0);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file        LCD_SPI.h
+ * @brief       Cabeceras del bus SPI compartido por la pantalla (ILI9341) y el táctil (XPT2046).
+ * 
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ * 
+ * @details     Ambos controladores usan la misma instancia SPI con chip selects
+ *              distintos. Este módulo inicializa el periférico una sola vez y
+ *              arbitra el acceso para que el muestreo del táctil desde una
+ *              interrupción no se mezcle con una transferencia de la pantalla.
+ *              Cada transacción (CS bajo, transferencia, CS alto) debe hacerse
+ *              entre LCD_SPI_acquire() y LCD_SPI_release(). Cada dispositivo fija
+ *              su frecuencia al empezar la transacción con LCD_SPI_setFrequency().
+ * 
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025, 
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_SPI.c, LCD_pinout.h
+ */
+
+#ifndef LCD_SPI_H
+#define LCD_SPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Frecuencias de reloj del bus.
+ */
+typedef enum {
+    LCD_SPI_FREQ_1M,
+    LCD_SPI_FREQ_2M,
+    LCD_SPI_FREQ_4M,
+    LCD_SPI_FREQ_8M
+} LCD_SPI_frequency_t;
+
+/**
+ * @brief Función a la que se avisa al terminar una transferencia asíncrona.
+ * 
+ * Se llama desde la interrupción del SPIM.
+ */
+typedef void (*LCD_SPI_handler_t)(void *context);
+
+/**
+ * @brief Inicializa el periférico SPI. Las llamadas posteriores no hacen nada.
+ */
+void LCD_SPI_init(void);
+
+/**
+ * @brief Reserva el bus para una transacción.
+ * 
+ * Desde el programa principal solo espera a que termine una transferencia
+ * asíncrona en curso: una interrupción que tenga el bus lo libera antes de
+ * devolver el control. Desde una interrupción hay que comprobar antes
+ * LCD_SPI_isBusy().
+ */
+void LCD_SPI_acquire(void);
+
+/**
+ * @brief Libera el bus reservado con LCD_SPI_acquire().
+ */
+void LCD_SPI_release(void);
+
+/**
+ * @brief Indica si hay una transacción en curso.
+ * 
+ * Pensada para las interrupciones: si el bus está ocupado por el programa
+ * principal, la interrupción debe dejar el trabajo para más tarde.
+ */
+bool LCD_SPI_isBusy(void);
+
+/**
+ * @brief Pide que se llame a `handler` en cuanto una transferencia asíncrona libere el bus.
+ * 
+ * Pensada para las interrupciones que encuentran el bus ocupado: un envío por DMA
+ * de varias filas seguidas lo tendría ocupado durante toda la ventana. `handler`
+ * se llama desde la interrupción del SPIM, entre esa transferencia y la siguiente,
+ * con el bus libre. Solo se guarda la última petición.
+ * 
+ * @return true si se ha aplazado; false si el bus no lo tiene una transferencia
+ *         asíncrona (lo tiene el programa principal, que lo libera entre transacciones).
+ */
+bool LCD_SPI_defer(LCD_SPI_handler_t handler, void *context);
+
+/**
+ * @brief Anula la petición de LCD_SPI_defer() de `handler`, si aún no se ha atendido.
+ * 
+ * Si no, se atendería al terminar la siguiente transferencia asíncrona, aunque
+ * fuera mucho después.
+ */
+void LCD_SPI_cancelDefer(LCD_SPI_handler_t handler);
+
+/**
+ * @brief Cambia la frecuencia del reloj para las siguientes transferencias.
+ * 
+ * Debe llamarse con el bus reservado. Si la frecuencia no cambia no se accede al
+ * periférico.
+ */
+void LCD_SPI_setFrequency(LCD_SPI_frequency_t frequency);
+
+/**
+ * @brief Realiza una transferencia bloqueante. El llamante controla el CS.
+ * 
+ * Si `tx` está en flash se envía por trozos a través de un buffer en RAM; en ese
+ * caso no se puede recibir a la vez (`rx_len` debe ser 0).
+ * 
+ * @param tx Bytes a enviar.
+ * @param tx_len Número de bytes a enviar.
+ * @param rx Buffer para los bytes recibidos (NULL si no se necesitan).
+ * @param rx_len Número de bytes a recibir.
+ */
+void LCD_SPI_xfer(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len);
+
+/**
+ * @brief Empieza a enviar por DMA y vuelve sin esperar. El llamante controla el CS.
+ * 
+ * El bus debe seguir reservado hasta que se llame a `handler`, normalmente
+ * liberándolo desde el propio aviso. Al liberarlo se atiende lo aplazado con
+ * LCD_SPI_defer().
+ * 
+ * @param tx Bytes a enviar. Deben estar en RAM y no cambiar hasta el aviso.
+ * @param tx_len Número de bytes a enviar (máximo 65535).
+ * @param handler Función a la que se avisa al terminar, desde la interrupción del SPIM.
+ * @param context Parámetro para `handler`.
+ */
+void LCD_SPI_xferAsync(const uint8_t *tx, size_t tx_len, LCD_SPI_handler_t handler, void *context);
+
+#endif
@@ -0,0 +1,273 @@
+/**
+ * @file        LCD_Stroke.c
+ * @brief       Implementación del motor de trazos suavizados para dibujar con el lápiz.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     La curva se evalúa en coma fija: coordenadas con 4 bits de parte
+ *              fraccionaria y t en [0, 256]. Entre cada par de puntos evaluados el
+ *              pincel avanza píxel a píxel (Bresenham) y en cada paso solo se añade
+ *              la columna o fila que entra en el cuadrado del pincel.
+ *
+ *              Formato de los puntos guardados: el primer punto, y cualquiera que se
+ *              aleje más de 127 píxeles del anterior, se guarda como el byte 0x80
+ *              seguido de x e y en 16 bits (little-endian). El resto se guardan como
+ *              dos bytes con signo (dx, dy).
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Stroke.h
+ */
+#include <stdlib.h>
+#include "LCD_Stroke.h"
+#include "LCD_GFX.h"
+
+#define STROKE_ABSOLUTE 0x80    // Marca de punto absoluto en los datos guardados
+#define STROKE_MAX_STEPS 64     // Maximo de puntos evaluados por tramo de curva
+
+/**
+ * @brief Rellena el rectangulo pendiente.
+ */
+static void LCD_Stroke_flush(LCD_Stroke_t *s) {
+    if (!s->span_valid) return;
+    // LCD_GFX_fillRect rellena de y a y+h, ambas incluidas
+    LCD_GFX_fillRect(s->span_x0, s->span_y0, s->span_x1 - s->span_x0 + 1, s->span_y1 - s->span_y0, s->color);
+    s->span_valid = false;
+}
+
+/**
+ * @brief Añade un rectangulo a rellenar, uniendolo al pendiente si lo continua en el mismo eje.
+ */
+static void LCD_Stroke_addSpan(LCD_Stroke_t *s, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    if (s->span_valid) {
+        // Mismas filas y contiguo en X
+        if (y0 == s->span_y0 && y1 == s->span_y1 && x0 <= s->span_x1 + 1 && x1 >= s->span_x0 - 1) {
+            if (x0 < s->span_x0) s->span_x0 = x0;
+            if (x1 > s->span_x1) s->span_x1 = x1;
+            return;
+        }
+        // Mismas columnas y contiguo en Y
+        if (x0 == s->span_x0 && x1 == s->span_x1 && y0 <= s->span_y1 + 1 && y1 >= s->span_y0 - 1) {
+            if (y0 < s->span_y0) s->span_y0 = y0;
+            if (y1 > s->span_y1) s->span_y1 = y1;
+            return;
+        }
+        LCD_Stroke_flush(s);
+    }
+    s->span_x0 = x0;
+    s->span_y0 = y0;
+    s->span_x1 = x1;
+    s->span_y1 = y1;
+    s->span_valid = true;
+}
+
+/**
+ * @brief Mueve el pincel un píxel (sx, sy en [-1, 1]) rellenando solo el borde nuevo.
+ */
+static void LCD_Stroke_step(LCD_Stroke_t *s, int8_t sx, int8_t sy) {
+    int16_t r = (s->width - 1) / 2;
+
+    s->pen_x += sx;
+    s->pen_y += sy;
+
+    int16_t left = s->pen_x - r;
+    int16_t top = s->pen_y - r;
+    int16_t right = left + s->width - 1;
+    int16_t bottom = top + s->width - 1;
+
+    if (sx != 0) {
+        int16_t col = sx > 0 ? right : left;
+        LCD_Stroke_addSpan(s, col, top, col, bottom);
+    }
+    if (sy != 0) {
+        int16_t row = sy > 0 ? bottom : top;
+        LCD_Stroke_addSpan(s, left, row, right, row);
+    }
+}
+
+/**
+ * @brief Lleva el pincel en línea recta hasta (x, y).
+ */
+static void LCD_Stroke_moveTo(LCD_Stroke_t *s, int16_t x, int16_t y) {
+    int16_t dx = abs(x - s->pen_x);
+    int16_t dy = -abs(y - s->pen_y);
+    int8_t sx = s->pen_x < x ? 1 : -1;
+    int8_t sy = s->pen_y < y ? 1 : -1;
+    int16_t err = dx + dy;
+
+    while (s->pen_x != x || s->pen_y != y) {
+        int16_t e2 = 2 * err;
+        int8_t step_x = 0, step_y = 0;
+        if (e2 >= dy) {
+            err += dy;
+            step_x = sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            step_y = sy;
+        }
+        LCD_Stroke_step(s, step_x, step_y);
+    }
+}
+
+/**
+ * @brief Estampa el pincel completo en la posicion actual.
+ */
+static void LCD_Stroke_stamp(LCD_Stroke_t *s) {
+    int16_t r = (s->width - 1) / 2;
+    int16_t left = s->pen_x - r;
+    int16_t top = s->pen_y - r;
+    LCD_Stroke_addSpan(s, left, top, left + s->width - 1, top + s->width - 1);
+}
+
+/**
+ * @brief Dibuja el tramo Catmull-Rom de p[1] a p[2].
+ */
+static void LCD_Stroke_drawSegment(LCD_Stroke_t *s) {
+    int32_t a[4][2];
+    int16_t (*p)[2] = s->p;
+
+    int16_t len_x = abs(p[2][0] - p[1][0]);
+    int16_t len_y = abs(p[2][1] - p[1][1]);
+    if (len_x == 0 && len_y == 0) return;
+
+    // Coeficientes del polinomio (multiplicados por 2 y en Q4)
+    for (uint8_t k = 0; k < 2; k++) {
+        int32_t p0 = p[0][k] << 4, p1 = p[1][k] << 4, p2 = p[2][k] << 4, p3 = p[3][k] << 4;
+        a[0][k] = 2 * p1;
+        a[1][k] = p2 - p0;
+        a[2][k] = 2 * p0 - 5 * p1 + 4 * p2 - p3;
+        a[3][k] = -p0 + 3 * p1 - 3 * p2 + p3;
+    }
+
+    // Un punto de la curva cada 2 pixeles, aproximadamente
+    uint16_t n = (len_x > len_y ? len_x : len_y) / 2 + 1;
+    if (n > STROKE_MAX_STEPS) n = STROKE_MAX_STEPS;
+
+    for (uint16_t i = 1; i <= n; i++) {
+        int32_t t = (i << 8) / n;
+        int16_t c[2];
+        for (uint8_t k = 0; k < 2; k++) {
+            int32_t v = a[3][k];
+            v = ((v * t) >> 8) + a[2][k];
+            v = ((v * t) >> 8) + a[1][k];
+            v = ((v * t) >> 8) + a[0][k];
+            c[k] = (v + 16) >> 5;
+        }
+        LCD_Stroke_moveTo(s, c[0], c[1]);
+    }
+}
+
+/**
+ * @brief Guarda un punto en el almacenamiento del trazo.
+ */
+static bool LCD_Stroke_store(LCD_Stroke_t *s, int16_t x, int16_t y, bool first) {
+    if (s->data == NULL) return true;
+    if (s->overflow) return false;
+
+    int16_t dx = x - s->p[3][0];
+    int16_t dy = y - s->p[3][1];
+    if (!first && abs(dx) <= 127 && abs(dy) <= 127) {
+        if (s->size + 2 > s->capacity) {
+            s->overflow = true;
+            return false;
+        }
+        s->data[s->size++] = (uint8_t)(int8_t)dx;
+        s->data[s->size++] = (uint8_t)(int8_t)dy;
+        return true;
+    }
+
+    if (s->size + 5 > s->capacity) {
+        s->overflow = true;
+        return false;
+    }
+    s->data[s->size++] = STROKE_ABSOLUTE;
+    s->data[s->size++] = x & 0xFF;
+    s->data[s->size++] = (uint16_t)x >> 8;
+    s->data[s->size++] = y & 0xFF;
+    s->data[s->size++] = (uint16_t)y >> 8;
+    return true;
+}
+
+void LCD_Stroke_begin(LCD_Stroke_t *s, uint8_t *buffer, uint16_t capacity, uint16_t color, uint8_t width) {
+    s->data = buffer;
+    s->capacity = capacity;
+    s->size = 0;
+    s->overflow = false;
+    s->color = color;
+    s->width = width > 0 ? width : 1;
+    s->points = 0;
+    s->span_valid = false;
+}
+
+bool LCD_Stroke_addPoint(LCD_Stroke_t *s, int16_t x, int16_t y) {
+    bool stored;
+
+    if (s->points == 0) {
+        stored = LCD_Stroke_store(s, x, y, true);
+        for (uint8_t i = 0; i < 4; i++) {
+            s->p[i][0] = x;
+            s->p[i][1] = y;
+        }
+        s->pen_x = x;
+        s->pen_y = y;
+        s->points = 1;
+        LCD_Stroke_stamp(s);
+        LCD_Stroke_flush(s);
+        return stored;
+    }
+
+    // Un punto repetido no cambia la curva
+    if (x == s->p[3][0] && y == s->p[3][1]) return !s->overflow;
+
+    stored = LCD_Stroke_store(s, x, y, false);
+    for (uint8_t i = 0; i < 3; i++) {
+        s->p[i][0] = s->p[i + 1][0];
+        s->p[i][1] = s->p[i + 1][1];
+    }
+    s->p[3][0] = x;
+    s->p[3][1] = y;
+    s->points++;
+
+    LCD_Stroke_drawSegment(s);
+    LCD_Stroke_flush(s);
+    return stored;
+}
+
+void LCD_Stroke_end(LCD_Stroke_t *s) {
+    if (s->points < 2) return;
+
+    // El ultimo tramo usa el punto final repetido como punto de control
+    for (uint8_t i = 0; i < 3; i++) {
+        s->p[i][0] = s->p[i + 1][0];
+        s->p[i][1] = s->p[i + 1][1];
+    }
+    LCD_Stroke_drawSegment(s);
+    LCD_Stroke_flush(s);
+    LCD_GFX_sync();
+}
+
+void LCD_Stroke_redraw(const LCD_Stroke_t *stroke) {
+    LCD_Stroke_t s;
+    int16_t x = 0, y = 0;
+    uint16_t i = 0;
+
+    LCD_Stroke_begin(&s, NULL, 0, stroke->color, stroke->width);
+    while (i < stroke->size) {
+        const uint8_t *d = &stroke->data[i];
+        if (d[0] == STROKE_ABSOLUTE) {
+            x = (int16_t)(d[1] | (d[2] << 8));
+            y = (int16_t)(d[3] | (d[4] << 8));
+            i += 5;
+        }
+        else {
+            x += (int8_t)d[0];
+            y += (int8_t)d[1];
+            i += 2;
+        }
+        LCD_Stroke_addPoint(&s, x, y);
+    }
+    LCD_Stroke_end(&s);
+}
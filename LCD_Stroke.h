@@ -0,0 +1,87 @@
+/**
+ * @file        LCD_Stroke.h
+ * @brief       Cabeceras del motor de trazos suavizados para dibujar con el lápiz.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     Un trazo recibe los puntos del táctil uno a uno, los une con una curva
+ *              Catmull-Rom (pasa por todos los puntos sin esquinas) y la dibuja con un
+ *              pincel cuadrado de grosor configurable. Al avanzar el pincel solo se
+ *              rellena el borde nuevo, agrupando los pasos seguidos en el mismo eje en
+ *              un único rectángulo, por lo que cada segmento son unas pocas ventanas
+ *              en lugar de un píxel por SPI. Los puntos pueden guardarse codificados
+ *              como diferencias de un byte por eje para volver a dibujar el trazo.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Stroke.c, LCD_GFX.h
+ */
+
+#ifndef LCD_STROKE_H
+#define LCD_STROKE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Trazo en curso o guardado.
+ *
+ * Los campos son internos, se manejan con las funciones LCD_Stroke_*.
+ */
+typedef struct {
+    // Almacenamiento de los puntos (puede ser NULL)
+    uint8_t *data;
+    uint16_t capacity;
+    uint16_t size;              // Bytes usados en data
+    bool overflow;              // No han cabido todos los puntos
+
+    uint16_t color;
+    uint8_t width;              // Grosor del pincel en píxeles
+
+    // Últimos cuatro puntos de control de la curva (p[3] el más reciente)
+    int16_t p[4][2];
+    uint16_t points;            // Puntos recibidos
+
+    // Posición actual del pincel y rectángulo pendiente de rellenar
+    int16_t pen_x, pen_y;
+    int16_t span_x0, span_y0, span_x1, span_y1;
+    bool span_valid;
+} LCD_Stroke_t;
+
+/**
+ * @brief Empieza un trazo nuevo.
+ *
+ * @param stroke Trazo a inicializar.
+ * @param buffer Memoria donde guardar los puntos para LCD_Stroke_redraw, o NULL para no
+ *               guardarlos. Cada punto ocupa normalmente 2 bytes.
+ * @param capacity Tamaño de `buffer` en bytes.
+ * @param color Color del trazo.
+ * @param width Grosor del trazo en píxeles.
+ */
+void LCD_Stroke_begin(LCD_Stroke_t *stroke, uint8_t *buffer, uint16_t capacity, uint16_t color, uint8_t width);
+
+/**
+ * @brief Añade un punto al trazo y dibuja el tramo de curva que ya se conoce.
+ *
+ * La curva entre dos puntos depende también del siguiente, por lo que el dibujo va
+ * un punto por detrás de la entrada; LCD_Stroke_end dibuja el último tramo.
+ *
+ * @return false si el punto no cabe en el almacenamiento (se dibuja igualmente).
+ */
+bool LCD_Stroke_addPoint(LCD_Stroke_t *stroke, int16_t x, int16_t y);
+
+/**
+ * @brief Termina el trazo dibujando su último tramo.
+ */
+void LCD_Stroke_end(LCD_Stroke_t *stroke);
+
+/**
+ * @brief Vuelve a dibujar un trazo guardado.
+ *
+ * @param stroke Trazo terminado con almacenamiento.
+ */
+void LCD_Stroke_redraw(const LCD_Stroke_t *stroke);
+
+#endif
@@ -1,25 +1,657 @@
+#include <string.h>
+#include "nrf.h"
+#include "nrf_delay.h"
+#include "app_timer.h"
+#include "fds.h"
 #include "LCD_TouchScreen.h"
 #include "XPT2046.h"
+#include "LCD_SPI.h"
 #include "LCD_GFX.h"
 
-void LCD_TouchScreen_readPosition(uint16_t *x, uint16_t *y) {
+// Dimensiones del panel en rotacion 0, en las que trabaja la calibracion
+#define PANEL_WIDTH  240
+#define PANEL_HEIGHT 320
+
+// Registro de FDS con la calibracion
+#define CALIBRATION_FILE_ID    0x7C41
+#define CALIBRATION_RECORD_KEY 0x0001
+#define CALIBRATION_MAGIC      0x43414C31  // "CAL1"
+
+/**
+ * @brief Calibracion tal y como se guarda en flash.
+ */
+typedef struct {
+    uint32_t magic;
+    LCD_TouchScreen_calibration_t matrix;
+} stored_calibration_t;
+
+static LCD_TouchScreen_calibration_t calibration;
+
+// Calibracion compuesta con cada rotacion de LCD_GFX, para no transformar dos veces
+static LCD_TouchScreen_calibration_t transform[4];
+
+// Estado de FDS, actualizado desde su manejador de eventos
+static volatile bool fds_initialized = false;
+static volatile bool fds_pending = false;
+static volatile ret_code_t fds_result;
+
+APP_TIMER_DEF(sampling_timer);
+static bool sampling_timer_created = false;
+
+/**
+ * @brief Cola circular de eventos con un productor (el temporizador) y un
+ * consumidor (la aplicación). `head` solo lo escribe el productor y `tail` solo
+ * el consumidor, por lo que no hace falta deshabilitar interrupciones.
+ */
+static struct {
+    LCD_TouchScreen_event_t events[LCD_TOUCH_QUEUE_SIZE];
+    volatile uint32_t head;     // Siguiente posicion a escribir
+    volatile uint32_t tail;     // Siguiente posicion a leer
+    uint32_t dropped;           // Eventos descartados por cola llena
+} queue;
+
+/**
+ * @brief Estado del suavizado exponencial de la posicion entre lecturas.
+ * 
+ * La posicion se guarda en valores crudos con 4 bits de parte fraccionaria y se
+ * reinicia cada vez que se levanta el lapiz.
+ */
+static struct {
+    uint8_t shift;              // Peso de la muestra nueva: 1 / 2^shift (0 = sin suavizado)
+    bool valid;                 // Hay una posicion previa desde que se apoyo el lapiz
+    int32_t x, y;               // Posicion suavizada (valores crudos << 4)
+} smoothing;
+
+// Estado del muestreo periodico
+static struct {
+    volatile bool enabled;      // Muestreo activado con LCD_TouchScreen_startSampling
+    volatile bool running;      // El temporizador esta en marcha (solo con el lapiz apoyado)
+    uint32_t period;            // Periodo del temporizador en ticks
+    bool touching;              // El lapiz estaba apoyado en la muestra anterior
+    bool idle;                  // Sin lapiz desde idle_since
+    uint32_t idle_since;        // Instante en ms en que se levanto el lapiz
+    uint16_t x, y;              // Ultima posicion muestreada
+    uint32_t last_ticks;        // Contador de app_timer en la ultima muestra
+    uint64_t ticks;             // Ticks acumulados desde el arranque
+    uint32_t millis;            // `ticks` en ms
+} sampler;
+
+// Se pone a true en la interrupcion de PENIRQ y a false al levantar el lapiz
+static volatile bool pen_down = false;
+
+typedef enum {
+    TOUCH_RELEASED,             // Sin toque
+    TOUCH_SETTLING,             // Lapiz apoyado, esperando settle_ms y el umbral de pulsacion
+    TOUCH_PRESSED               // Toque valido hasta bajar del umbral de liberacion
+} touch_state_t;
+
+// Maquina de estados del toque, con histeresis entre los dos umbrales
+static struct {
+    touch_state_t state;
+    uint32_t since;             // Instante en ms en que se entro en TOUCH_SETTLING
+    uint16_t press;             // Presion para pasar a TOUCH_PRESSED
+    uint16_t release;           // Presion por debajo de la cual se suelta
+    uint16_t settle_ms;         // Espera tras apoyar el lapiz
+} touch = {
+    .state = TOUCH_RELEASED,
+    .press = LCD_TOUCH_PRESS_THRESHOLD,
+    .release = LCD_TOUCH_RELEASE_THRESHOLD,
+    .settle_ms = LCD_TOUCH_SETTLE_MS
+};
+
+/**
+ * @brief Llamada desde la interrupcion de PENIRQ al tocar la pantalla.
+ */
+static void LCD_TouchScreen_onPenDown(void) {
+    pen_down = true;
+
+    // Sin lapiz no se muestrea: el temporizador arranca con el toque
+    if (sampler.enabled && !sampler.running) {
+        sampler.running = (app_timer_start(sampling_timer, sampler.period, NULL) == NRF_SUCCESS);
+    }
+}
+
+/**
+ * @brief Lee la posicion filtrada (mediana, rechazo y suavizado) y la pasa a pixeles.
+ * 
+ * @return false si la lectura se ha rechazado. En ese caso se devuelve la ultima
+ *         posicion valida, o la mediana si aun no habia ninguna.
+ */
+static bool LCD_TouchScreen_readFiltered(uint16_t *x, uint16_t *y) {
     uint16_t raw_x, raw_y;
-    XPT2046_readPosition(&raw_x, &raw_y);
+    bool accepted = XPT2046_readPosition(&raw_x, &raw_y);
+
+    if (accepted) {
+        if (!smoothing.valid) {
+            smoothing.x = raw_x << 4;
+            smoothing.y = raw_y << 4;
+            smoothing.valid = true;
+        }
+        else {
+            smoothing.x += (((int32_t)raw_x << 4) - smoothing.x) >> smoothing.shift;
+            smoothing.y += (((int32_t)raw_y << 4) - smoothing.y) >> smoothing.shift;
+        }
+    }
+    if (smoothing.valid) {
+        raw_x = smoothing.x >> 4;
+        raw_y = smoothing.y >> 4;
+    }
 
-    // Fórmulas invertidas (para 0,0 = esquina superior izquierda)
-    *x = (uint16_t)((raw_x - MIN_X) * LCD_WIDTH / (MAX_X - MIN_X));
-    *y = (uint16_t)((raw_y - MIN_Y) * LCD_HEIGHT / (MAX_Y - MIN_Y));
+    // Transformacion afin de la rotacion actual (Q16.16, redondeando)
+    uint8_t rotation = LCD_GFX_getRotation() & 3;
+    const LCD_TouchScreen_calibration_t *t = &transform[rotation];
+    int32_t width  = (rotation % 2 == 0) ? PANEL_WIDTH  : PANEL_HEIGHT;
+    int32_t height = (rotation % 2 == 0) ? PANEL_HEIGHT : PANEL_WIDTH;
+    int32_t px = (t->a * raw_x + t->b * raw_y + t->c + 0x8000) >> 16;
+    int32_t py = (t->d * raw_x + t->e * raw_y + t->f + 0x8000) >> 16;
 
+    *x = px < 0 ? 0 : (px >= width  ? width - 1  : px);
+    *y = py < 0 ? 0 : (py >= height ? height - 1 : py);
+    return accepted;
+}
+
+void LCD_TouchScreen_readPosition(uint16_t *x, uint16_t *y) {
+    LCD_TouchScreen_readFiltered(x, y);
+}
+
+void LCD_TouchScreen_setFilter(uint8_t samples, uint16_t max_spread, uint8_t smoothing_shift) {
+    XPT2046_filter_t filter = { .samples = samples, .max_spread = max_spread };
+    XPT2046_setFilter(&filter);
+    smoothing.shift = smoothing_shift;
 }
 
 uint16_t LCD_TouchScreen_readPressure() {
     return XPT2046_readPressure();
 }
+/**
+ * @brief Avanza la maquina de estados del toque con una nueva medida de presion.
+ * 
+ * @param pressure Si no es NULL, devuelve la presion medida (0 sin lapiz).
+ * @return true si el toque es valido (TOUCH_PRESSED).
+ */
+static bool LCD_TouchScreen_updateTouch(uint16_t *pressure) {
+    uint16_t p = 0;
+
+    // PENIRQ vuelve a nivel alto al levantar el lapiz
+    if (pen_down && !XPT2046_isPenDown()) {
+        pen_down = false;
+    }
+
+    if (!pen_down) {
+        touch.state = TOUCH_RELEASED;
+    }
+    else {
+        p = XPT2046_readPressure();
+        switch (touch.state) {
+            case TOUCH_RELEASED:
+                touch.state = TOUCH_SETTLING;
+                touch.since = LCD_TouchScreen_millis();
+                // fall through
+            case TOUCH_SETTLING:
+                // Las primeras medidas tras apoyar el lapiz no son fiables
+                if (LCD_TouchScreen_millis() - touch.since >= touch.settle_ms && p >= touch.press) {
+                    touch.state = TOUCH_PRESSED;
+                }
+                break;
+            case TOUCH_PRESSED:
+                if (p < touch.release) {
+                    touch.state = TOUCH_SETTLING;
+                    touch.since = LCD_TouchScreen_millis();
+                }
+                break;
+        }
+    }
+
+    if (touch.state != TOUCH_PRESSED) smoothing.valid = false;
+    if (pressure) *pressure = p;
+    return touch.state == TOUCH_PRESSED;
+}
+
 bool LCD_TouchScreen_isTouched() {
-    // El valor 350 es un valor de pruebas, cuanto más bajo, más sensible será la pantalla
-    return XPT2046_readPressure() > 350;
+    return LCD_TouchScreen_updateTouch(NULL);
+}
+
+void LCD_TouchScreen_setThresholds(uint16_t press, uint16_t release, uint16_t settle_ms) {
+    touch.press = press;
+    touch.release = release < press ? release : press;
+    touch.settle_ms = settle_ms;
+}
+
+void LCD_TouchScreen_waitForTouch() {
+    while (!LCD_TouchScreen_isTouched()) {
+        if (!pen_down) __WFE();
+    }
+}
+
+/**
+ * @brief Mete un evento en la cola (productor).
+ */
+static void LCD_TouchScreen_push(LCD_TouchScreen_event_type_t type, uint16_t pressure) {
+    uint32_t head = queue.head;
+    if (head - queue.tail == LCD_TOUCH_QUEUE_SIZE) {
+        queue.dropped++;
+        return;
+    }
+
+    LCD_TouchScreen_event_t *ev = &queue.events[head & (LCD_TOUCH_QUEUE_SIZE - 1)];
+    ev->type = type;
+    ev->x = sampler.x;
+    ev->y = sampler.y;
+    ev->pressure = pressure;
+    ev->timestamp = sampler.millis;
+    LCD_LATENCY_EVENT(ev);
+
+    __DMB();    // El evento debe estar escrito antes de publicarlo
+    queue.head = head + 1;
+}
+
+/**
+ * @brief Actualiza el reloj en ms a partir del contador de app_timer.
+ * 
+ * El contador de app_timer es de 24 bits, por lo que se acumulan las diferencias
+ * entre muestras para que las marcas de tiempo no den la vuelta. Como sin toque el
+ * temporizador esta parado, si pasa mas de una vuelta del contador sin llamadas se
+ * pierde esa vuelta: las marcas de tiempo solo sirven para medir intervalos dentro
+ * de un toque o entre toques seguidos.
+ */
+static void LCD_TouchScreen_updateMillis(void) {
+    // Al reproducir una sesion grabada se usa su reloj
+    uint32_t replay_time;
+    if (XPT2046_getReplayTime(&replay_time)) {
+        sampler.millis = replay_time;
+        return;
+    }
+
+    uint32_t now = app_timer_cnt_get();
+    sampler.ticks += app_timer_cnt_diff_compute(now, sampler.last_ticks);
+    sampler.last_ticks = now;
+    sampler.millis = (uint32_t)(sampler.ticks * 1000 / APP_TIMER_CLOCK_FREQ);
+}
+
+/**
+ * @brief Rutina del temporizador de muestreo.
+ */
+static void LCD_TouchScreen_sample(void *context) {
+    // Muestra aplazada que llega tras LCD_TouchScreen_stopSampling
+    if (!sampler.enabled) return;
+
+    // La pantalla esta usando el bus: si esta enviando por DMA se muestrea entre dos
+    // envios, y si no en el siguiente periodo
+    if (LCD_SPI_isBusy()) {
+        LCD_SPI_defer(LCD_TouchScreen_sample, NULL);
+        return;
+    }
+
+    LCD_TouchScreen_updateMillis();
+
+    // Toque sin flanco de PENIRQ, como al reproducir una sesion grabada
+    if (!pen_down && XPT2046_isPenDown()) {
+        LCD_TouchScreen_onPenDown();
+    }
+
+    uint16_t pressure;
+    bool touched = LCD_TouchScreen_updateTouch(&pressure);
+    if (touched) {
+        // Las lecturas rechazadas por el filtro no generan evento
+        if (!LCD_TouchScreen_readFiltered(&sampler.x, &sampler.y)) return;
+        LCD_TouchScreen_push(sampler.touching ? LCD_TOUCH_MOVE : LCD_TOUCH_DOWN, pressure);
+    }
+    else if (sampler.touching) {
+        LCD_TouchScreen_push(LCD_TOUCH_UP, 0);
+    }
+    sampler.touching = touched;
+
+    if (touched || pen_down) {
+        sampler.idle = false;
+        return;
+    }
+    if (!sampler.idle) {
+        sampler.idle = true;
+        sampler.idle_since = sampler.millis;
+    }
+
+    // Lapiz levantado un rato: parar hasta la siguiente interrupcion de PENIRQ. Sin
+    // lapiz las muestras no acceden al SPI, solo despiertan a la aplicacion para
+    // que complete los gestos que dependen del tiempo (doble toque).
+    if (sampler.millis - sampler.idle_since >= LCD_TOUCH_IDLE_MS && !XPT2046_getReplayTime(NULL)) {
+        app_timer_stop(sampling_timer);
+        sampler.running = false;
+
+        // Si se ha vuelto a tocar mientras se paraba, PENIRQ no ha podido arrancarlo
+        if (XPT2046_isPenDown()) {
+            LCD_TouchScreen_onPenDown();
+        }
+    }
+}
+
+uint32_t LCD_TouchScreen_millis() {
+    // El reloj tambien lo actualiza la rutina de muestreo
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    LCD_TouchScreen_updateMillis();
+    uint32_t millis = sampler.millis;
+    __set_PRIMASK(primask);
+    return millis;
+}
+
+bool LCD_TouchScreen_startSampling(uint16_t rate_hz) {
+    if (rate_hz == 0) return false;
+    if (!sampling_timer_created) {
+        if (app_timer_create(&sampling_timer, APP_TIMER_MODE_REPEATED, LCD_TouchScreen_sample) != NRF_SUCCESS) {
+            return false;
+        }
+        sampling_timer_created = true;
+    }
+
+    // En ticks y no en ms, que redondearia el periodo (300 Hz serian 333 Hz). Por debajo
+    // del minimo app_timer_start falla y el muestreo no arrancaria nunca
+    uint32_t period = APP_TIMER_CLOCK_FREQ / rate_hz;
+    sampler.period = period > APP_TIMER_MIN_TIMEOUT_TICKS ? period : APP_TIMER_MIN_TIMEOUT_TICKS;
+    sampler.touching = false;
+    sampler.idle = false;
+    sampler.last_ticks = app_timer_cnt_get();
+    sampler.enabled = true;
+
+    // Si ya hay un toque no llegara el flanco de PENIRQ
+    if (pen_down || XPT2046_isPenDown()) {
+        LCD_TouchScreen_onPenDown();
+        return sampler.running;
+    }
+    return true;
+}
+
+void LCD_TouchScreen_stopSampling() {
+    sampler.enabled = false;
+    app_timer_stop(sampling_timer);
+    LCD_SPI_cancelDefer(LCD_TouchScreen_sample);
+    sampler.running = false;
+}
+
+bool LCD_TouchScreen_getEvent(LCD_TouchScreen_event_t *event) {
+    uint32_t tail = queue.tail;
+    if (tail == queue.head) return false;
+
+    __DMB();    // Leer el evento despues de ver el nuevo head
+    *event = queue.events[tail & (LCD_TOUCH_QUEUE_SIZE - 1)];
+    __DMB();    // Terminar de leer antes de liberar la posicion
+    queue.tail = tail + 1;
+    return true;
+}
+
+uint32_t LCD_TouchScreen_droppedEvents() {
+    return queue.dropped;
+}
+
+// ------------------------
+// Calibracion
+// ------------------------
+
+/**
+ * @brief Calibracion equivalente a las constantes MIN_X, MIN_Y, MAX_X y MAX_Y.
+ * 
+ * En este panel el eje X crudo crece de derecha a izquierda, por lo que se invierte.
+ */
+static void LCD_TouchScreen_defaultCalibration(LCD_TouchScreen_calibration_t *cal) {
+    cal->a = -((int32_t)PANEL_WIDTH << 16) / (MAX_X - MIN_X);
+    cal->b = 0;
+    cal->c = ((int32_t)PANEL_WIDTH << 16) - cal->a * MIN_X;
+    cal->d = 0;
+    cal->e = ((int32_t)PANEL_HEIGHT << 16) / (MAX_Y - MIN_Y);
+    cal->f = -cal->e * MIN_Y;
+}
+
+/**
+ * @brief Calcula la matriz afin que lleva los tres puntos crudos `raw` a `screen`.
+ * 
+ * @return false si los puntos estan alineados y no hay solucion.
+ */
+static bool LCD_TouchScreen_solveCalibration(const int32_t raw[3][2], const int32_t screen[3][2],
+                                             LCD_TouchScreen_calibration_t *cal) {
+    int64_t dx1 = raw[0][0] - raw[2][0], dy1 = raw[0][1] - raw[2][1];
+    int64_t dx2 = raw[1][0] - raw[2][0], dy2 = raw[1][1] - raw[2][1];
+    int64_t det = dx1 * dy2 - dx2 * dy1;
+    if (det == 0) return false;
+
+    int32_t *row[2][3] = { {&cal->a, &cal->b, &cal->c}, {&cal->d, &cal->e, &cal->f} };
+    for (uint8_t axis = 0; axis < 2; axis++) {
+        int64_t s1 = screen[0][axis] - screen[2][axis];
+        int64_t s2 = screen[1][axis] - screen[2][axis];
+        // Se multiplica en lugar de desplazar: los numeradores pueden ser negativos
+        int64_t m = (s1 * dy2 - s2 * dy1) * 65536 / det;
+        int64_t n = (dx1 * s2 - dx2 * s1) * 65536 / det;
+        *row[axis][0] = (int32_t)m;
+        *row[axis][1] = (int32_t)n;
+        *row[axis][2] = (int32_t)((int64_t)screen[2][axis] * 65536 - m * raw[2][0] - n * raw[2][1]);
+    }
+    return true;
+}
+
+/**
+ * @brief Convierte un punto del panel (rotacion 0) a coordenadas de la rotacion actual.
+ */
+static void LCD_TouchScreen_panelToScreen(int16_t px, int16_t py, int16_t *x, int16_t *y) {
+    switch (LCD_GFX_getRotation() & 3) {
+        case 1:
+            *x = py;
+            *y = PANEL_WIDTH - 1 - px;
+            break;
+        case 2:
+            *x = PANEL_WIDTH - 1 - px;
+            *y = PANEL_HEIGHT - 1 - py;
+            break;
+        case 3:
+            *x = PANEL_HEIGHT - 1 - py;
+            *y = px;
+            break;
+        default:
+            *x = px;
+            *y = py;
+    }
+}
+
+/**
+ * @brief Espera a que se toque la cruz dibujada en (x, y) y devuelve la lectura cruda media.
+ */
+static void LCD_TouchScreen_capturePoint(int16_t x, int16_t y, int32_t raw[2]) {
+    uint32_t sum_x = 0, sum_y = 0;
+    uint8_t n = 0;
+
+    LCD_GFX_drawLine(x - 8, y, x + 8, y, RED);
+    LCD_GFX_drawLine(x, y - 8, x, y + 8, RED);
+
+    // Promediar lecturas aceptadas mientras el lapiz esta apoyado
+    while (n < 16) {
+        LCD_TouchScreen_waitForTouch();
+        uint16_t rx, ry;
+        if (XPT2046_readPosition(&rx, &ry)) {
+            sum_x += rx;
+            sum_y += ry;
+            n++;
+        }
+        nrf_delay_ms(5);
+    }
+    raw[0] = sum_x / n;
+    raw[1] = sum_y / n;
+
+    LCD_GFX_drawLine(x - 8, y, x + 8, y, BLACK);
+    LCD_GFX_drawLine(x, y - 8, x, y + 8, BLACK);
+
+    // Esperar a que se levante el lapiz
+    while (LCD_TouchScreen_isTouched());
+    nrf_delay_ms(200);
+}
+
+bool LCD_TouchScreen_calibrate() {
+    const int32_t screen[3][2] = {
+        { PANEL_WIDTH / 10,     PANEL_HEIGHT / 10 },
+        { PANEL_WIDTH * 9 / 10, PANEL_HEIGHT / 2 },
+        { PANEL_WIDTH / 2,      PANEL_HEIGHT * 9 / 10 }
+    };
+    int32_t raw[3][2];
+    LCD_TouchScreen_calibration_t cal;
+
+    // Las cruces se dibujan en la rotacion actual (que puede ser fija, ver
+    // ILI9341_FIXED_ROTATION) en la posicion del panel que les corresponde
+    LCD_GFX_fillScreen(BLACK);
+    LCD_GFX_drawString(20, LCD_HEIGHT / 2 - 30, "Toca las cruces", WHITE, BLACK, 2);
+    for (uint8_t i = 0; i < 3; i++) {
+        int16_t x, y;
+        LCD_TouchScreen_panelToScreen(screen[i][0], screen[i][1], &x, &y);
+        LCD_TouchScreen_capturePoint(x, y, raw[i]);
+    }
+
+    if (!LCD_TouchScreen_solveCalibration(raw, screen, &cal)) return false;
+
+    LCD_TouchScreen_setCalibration(&cal);
+    LCD_TouchScreen_saveCalibration();
+    return true;
+}
+
+void LCD_TouchScreen_setCalibration(const LCD_TouchScreen_calibration_t *cal) {
+    const int32_t max_x = (PANEL_WIDTH - 1) << 16;
+    const int32_t max_y = (PANEL_HEIGHT - 1) << 16;
+
+    calibration = *cal;
+
+    // Rotacion 0: la calibracion tal cual
+    transform[0] = *cal;
+
+    // Rotacion 1: (x, y) -> (y, 239 - x)
+    transform[1] = (LCD_TouchScreen_calibration_t){
+        cal->d, cal->e, cal->f,
+        -cal->a, -cal->b, max_x - cal->c
+    };
+
+    // Rotacion 2: (x, y) -> (239 - x, 319 - y)
+    transform[2] = (LCD_TouchScreen_calibration_t){
+        -cal->a, -cal->b, max_x - cal->c,
+        -cal->d, -cal->e, max_y - cal->f
+    };
+
+    // Rotacion 3: (x, y) -> (319 - y, x)
+    transform[3] = (LCD_TouchScreen_calibration_t){
+        -cal->d, -cal->e, max_y - cal->f,
+        cal->a, cal->b, cal->c
+    };
+}
+
+void LCD_TouchScreen_getCalibration(LCD_TouchScreen_calibration_t *cal) {
+    *cal = calibration;
+}
+
+/**
+ * @brief Manejador de eventos de FDS.
+ */
+static void LCD_TouchScreen_fdsHandler(fds_evt_t const *evt) {
+    switch (evt->id) {
+        case FDS_EVT_INIT:
+            fds_initialized = (evt->result == NRF_SUCCESS);
+            fds_pending = false;
+            break;
+        case FDS_EVT_WRITE:
+        case FDS_EVT_UPDATE:
+        case FDS_EVT_GC:
+            fds_result = evt->result;
+            fds_pending = false;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Espera a que termine la operacion de FDS en curso.
+ */
+static void LCD_TouchScreen_fdsWait(void) {
+    while (fds_pending) {
+        __WFE();
+    }
+}
+
+/**
+ * @brief Inicializa FDS y carga la calibracion guardada, si la hay.
+ * @return true si se ha cargado una calibracion valida.
+ */
+static bool LCD_TouchScreen_loadCalibration(LCD_TouchScreen_calibration_t *cal) {
+    fds_record_desc_t desc;
+    fds_find_token_t token;
+    fds_flash_record_t record;
+    bool loaded = false;
+
+    fds_register(LCD_TouchScreen_fdsHandler);
+    fds_pending = true;
+    if (fds_init() != NRF_SUCCESS) {
+        fds_pending = false;
+        return false;
+    }
+    LCD_TouchScreen_fdsWait();
+    if (!fds_initialized) return false;
+
+    memset(&token, 0, sizeof(token));
+    if (fds_record_find(CALIBRATION_FILE_ID, CALIBRATION_RECORD_KEY, &desc, &token) != NRF_SUCCESS) return false;
+    if (fds_record_open(&desc, &record) != NRF_SUCCESS) return false;
+
+    const stored_calibration_t *stored = (const stored_calibration_t *)record.p_data;
+    if (stored->magic == CALIBRATION_MAGIC) {
+        *cal = stored->matrix;
+        loaded = true;
+    }
+    fds_record_close(&desc);
+    return loaded;
+}
+
+bool LCD_TouchScreen_saveCalibration() {
+    // Los datos deben seguir siendo validos hasta que FDS termine de escribir
+    static stored_calibration_t stored;
+    fds_record_desc_t desc;
+    fds_find_token_t token;
+    ret_code_t err;
+
+    if (!fds_initialized) return false;
+
+    stored.magic = CALIBRATION_MAGIC;
+    stored.matrix = calibration;
+    fds_record_t record = {
+        .file_id = CALIBRATION_FILE_ID,
+        .key = CALIBRATION_RECORD_KEY,
+        .data.p_data = &stored,
+        .data.length_words = (sizeof(stored) + 3) / 4
+    };
+
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        memset(&token, 0, sizeof(token));
+        fds_pending = true;
+        if (fds_record_find(CALIBRATION_FILE_ID, CALIBRATION_RECORD_KEY, &desc, &token) == NRF_SUCCESS) {
+            err = fds_record_update(&desc, &record);
+        }
+        else {
+            err = fds_record_write(NULL, &record);
+        }
+
+        // Sin espacio: liberar los registros antiguos y reintentar
+        if (err == FDS_ERR_NO_SPACE_IN_FLASH) {
+            fds_pending = true;
+            if (fds_gc() != NRF_SUCCESS) break;
+            LCD_TouchScreen_fdsWait();
+            continue;
+        }
+        if (err != NRF_SUCCESS) break;
+
+        LCD_TouchScreen_fdsWait();
+        return fds_result == NRF_SUCCESS;
+    }
+    fds_pending = false;
+    return false;
 }
 
 void LCD_TouchScreen_init() {
+    LCD_TouchScreen_calibration_t cal;
+    if (!LCD_TouchScreen_loadCalibration(&cal)) {
+        LCD_TouchScreen_defaultCalibration(&cal);
+    }
+    LCD_TouchScreen_setCalibration(&cal);
+
     XPT2046_init();
+    XPT2046_enablePenIrq(LCD_TouchScreen_onPenDown);
+    pen_down = XPT2046_isPenDown();
 }
@@ -19,20 +19,84 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "LCD_Latency.h"
 
-// Calibracion de la pantalla
+// Calibracion por defecto de la pantalla, usada si no hay ninguna guardada en flash
 #define MIN_X 225
 #define MIN_Y 300
 #define MAX_X 3800
 #define MAX_Y 3700
 
+/**
+ * @brief Matriz de calibración afín del táctil, en coma fija Q16.16.
+ * 
+ * Convierte los valores crudos (xr, yr) en píxeles de la pantalla en rotación 0:
+ *      x = (a * xr + b * yr + c) >> 16
+ *      y = (d * xr + e * yr + f) >> 16
+ * Además de escalar y desplazar, corrige el giro y la inclinación del panel.
+ */
+typedef struct {
+    int32_t a, b, c;
+    int32_t d, e, f;
+} LCD_TouchScreen_calibration_t;
+
+// Umbrales de presion por defecto (ver XPT2046_readPressure) y espera tras apoyar el lapiz
+#define LCD_TOUCH_PRESS_THRESHOLD   1200
+#define LCD_TOUCH_RELEASE_THRESHOLD 800
+#define LCD_TOUCH_SETTLE_MS         10
+
+// Tiempo que sigue el muestreo tras levantar el lapiz antes de pararse
+#define LCD_TOUCH_IDLE_MS 500
+
+// Capacidad de la cola de eventos (potencia de 2)
+#define LCD_TOUCH_QUEUE_SIZE 32
+
+/**
+ * @brief Tipo de evento del táctil.
+ */
+typedef enum {
+    LCD_TOUCH_DOWN,     // Se ha apoyado el lápiz
+    LCD_TOUCH_MOVE,     // El lápiz sigue apoyado (nueva muestra)
+    LCD_TOUCH_UP        // Se ha levantado el lápiz (posición de la última muestra)
+} LCD_TouchScreen_event_type_t;
+
+/**
+ * @brief Evento del táctil generado por el muestreo periódico.
+ */
+typedef struct {
+    LCD_TouchScreen_event_type_t type;
+    uint16_t x;             // Posición en píxeles, en la rotación actual de LCD_GFX
+    uint16_t y;
+    uint16_t pressure;      // Presión, rango [0-4095]
+    uint32_t timestamp;     // Instante de la muestra en ms
+#if LCD_LATENCY_ENABLED
+    uint32_t latency_sample;    // Marcas de LCD_Latency (ciclos)
+    uint32_t latency_event;
+#endif
+} LCD_TouchScreen_event_t;
+
 /**
  * @brief Lee y procesa la posición de donde está siendo tocada la pantalla
+ * 
+ * Las coordenadas siguen la rotación actual de LCD_GFX, igual que las de dibujo.
  * @param x Puntero a la variable donde se almacenará X (en píxeles, rango [0, LCD_WIDTH - 1])
  * @param y Puntero a la variable donde se almacenará Y (en píxeles, rango [0, LCD_HEIGHT - 1])
  */
 void LCD_TouchScreen_readPosition(uint16_t *x, uint16_t *y);
 
+/**
+ * @brief Configura el filtrado de la posición.
+ * 
+ * Cada lectura toma la mediana de `samples` muestras y se descarta si su dispersión
+ * supera `max_spread`. Después, la posición se suaviza entre lecturas con un filtro
+ * exponencial que se reinicia al levantar el lápiz.
+ * 
+ * @param samples Muestras por lectura, [1, 8]. Por defecto 5.
+ * @param max_spread Dispersión máxima en valores crudos [0, 4095], 0 para no descartar. Por defecto 40.
+ * @param smoothing_shift La muestra nueva pesa 1 / 2^smoothing_shift. 0 (por defecto) desactiva el suavizado.
+ */
+void LCD_TouchScreen_setFilter(uint8_t samples, uint16_t max_spread, uint8_t smoothing_shift);
+
 /**
  * @brief Mide la presión del toque actual.
  * @return Valor de presión, rango [0-4095].
@@ -41,12 +105,111 @@ uint16_t LCD_TouchScreen_readPressure(void);
 
 /**
  * @brief Detecta presencia de toque en el panel.
- * @return true si se detecta toque válido (presión > umbral mínimo), false en caso contrario.
+ * 
+ * Mientras no llega la interrupción de toque (PENIRQ) no se accede al SPI, por lo
+ * que puede llamarse en bucle sin ocupar el bus compartido con la pantalla.
+ * 
+ * El toque se da por válido cuando, pasados `settle_ms` desde que se apoya el lápiz,
+ * la presión supera el umbral de pulsación, y deja de serlo cuando baja del umbral
+ * de liberación. Al ser distintos, la presión cerca de un umbral no hace parpadear
+ * el estado.
+ * 
+ * @return true si se detecta toque válido, false en caso contrario.
  */
 bool LCD_TouchScreen_isTouched(void);
 
 /**
- * @brief Inicializa el táctil.
+ * @brief Configura los umbrales de presión del toque.
+ * 
+ * @param press Presión para dar el toque por válido. Por defecto LCD_TOUCH_PRESS_THRESHOLD.
+ * @param release Presión por debajo de la cual se suelta, no mayor que `press`.
+ *                Por defecto LCD_TOUCH_RELEASE_THRESHOLD.
+ * @param settle_ms Espera tras apoyar el lápiz antes de aceptar el toque. Por defecto LCD_TOUCH_SETTLE_MS.
+ */
+void LCD_TouchScreen_setThresholds(uint16_t press, uint16_t release, uint16_t settle_ms);
+
+/**
+ * @brief Duerme el procesador hasta que se toca la pantalla.
+ */
+void LCD_TouchScreen_waitForTouch(void);
+
+/**
+ * @brief Empieza a muestrear el táctil periódicamente desde un temporizador.
+ * 
+ * El temporizador solo funciona mientras el lápiz está apoyado: se arranca con la
+ * interrupción de PENIRQ y se para LCD_TOUCH_IDLE_MS después de levantar el lápiz,
+ * por lo que sin toque no hay accesos al SPI ni despertares del procesador.
+ * 
+ * Cada muestra genera un evento LCD_TOUCH_DOWN, LCD_TOUCH_MOVE o LCD_TOUCH_UP que
+ * se guarda en una cola hasta que la aplicación lo lee con LCD_TouchScreen_getEvent(),
+ * de forma que los toques no se pierden aunque el dibujado de un frame sea lento.
+ * Si al vencer el temporizador la pantalla está usando el bus SPI, la muestra se
+ * toma entre dos envíos por DMA (LCD_SPI_defer) o, si no, en el siguiente periodo.
+ * 
+ * @param rate_hz Frecuencia de muestreo con el lápiz apoyado, en Hz (p. ej. 200). Las
+ *                frecuencias mayores que la que admite app_timer se limitan a esa.
+ * @return false si `rate_hz` es 0 o no se ha podido crear o arrancar el temporizador.
+ * @note El módulo app_timer debe estar inicializado (app_timer_init()).
+ */
+bool LCD_TouchScreen_startSampling(uint16_t rate_hz);
+
+/**
+ * @brief Detiene el muestreo periódico. Los eventos pendientes se conservan.
+ */
+void LCD_TouchScreen_stopSampling(void);
+
+/**
+ * @brief Saca el evento más antiguo de la cola.
+ * 
+ * @param event Puntero donde se copiará el evento.
+ * @return true si había algún evento, false si la cola estaba vacía.
+ */
+bool LCD_TouchScreen_getEvent(LCD_TouchScreen_event_t *event);
+
+/**
+ * @brief Número de eventos descartados porque la cola estaba llena.
+ */
+uint32_t LCD_TouchScreen_droppedEvents(void);
+
+/**
+ * @brief Devuelve el instante actual en ms, en la misma base que las marcas de tiempo
+ * de los eventos.
+ */
+uint32_t LCD_TouchScreen_millis(void);
+
+/**
+ * @brief Calibra el táctil pidiendo al usuario que toque tres puntos de la pantalla.
+ * 
+ * Calcula la matriz afín que lleva las lecturas a los tres puntos, la aplica y la
+ * guarda en flash (FDS) para las siguientes ejecuciones. Las cruces se dibujan en la
+ * rotación actual de la pantalla.
+ * 
+ * @return true si la calibración es válida, false si los puntos tocados están
+ *         alineados (se mantiene la calibración anterior).
+ */
+bool LCD_TouchScreen_calibrate(void);
+
+/**
+ * @brief Establece la matriz de calibración (no la guarda en flash).
+ */
+void LCD_TouchScreen_setCalibration(const LCD_TouchScreen_calibration_t *calibration);
+
+/**
+ * @brief Obtiene la matriz de calibración actual.
+ */
+void LCD_TouchScreen_getCalibration(LCD_TouchScreen_calibration_t *calibration);
+
+/**
+ * @brief Guarda la matriz de calibración actual en flash (FDS).
+ * @return true si se ha guardado correctamente.
+ */
+bool LCD_TouchScreen_saveCalibration(void);
+
+/**
+ * @brief Inicializa el táctil y la interrupción de toque.
+ * 
+ * Carga la calibración guardada en flash o, si no hay ninguna, la calculada a
+ * partir de MIN_X, MIN_Y, MAX_X y MAX_Y.
  */
 void LCD_TouchScreen_init(void);
 
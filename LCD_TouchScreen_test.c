@@ -17,8 +17,12 @@
 
 #include "LCD_GFX.h"
 #include "LCD_TouchScreen.h"
+#include "LCD_Gesture.h"
+#include "LCD_Stroke.h"
 #include "XPT2046.h"
+#include "nrf.h"
 #include "nrf_delay.h"
+#include "nrf_log.h"
 #include <stdio.h>
 
 void LCD_TouchScreen_test_pressure() {
@@ -28,6 +32,11 @@ void LCD_TouchScreen_test_pressure() {
 	LCD_GFX_drawString(0, LCD_HEIGHT >> 2, "Touch the screen!", WHITE, BLACK, 2);
 	LCD_GFX_drawString(0, LCD_HEIGHT >> 1, "Pressure:", WHITE, BLACK, 3);
 	while(1) {
+		// Sin toque se duerme hasta la interrupcion de PENIRQ en lugar de leer el SPI
+		if (!LCD_TouchScreen_isTouched()) {
+			LCD_GFX_drawString(160, LCD_HEIGHT >> 1, "0     ", GREEN, BLACK, 3);
+			LCD_TouchScreen_waitForTouch();
+		}
 		pressure = LCD_TouchScreen_readPressure();
 		sprintf(buffer,"%d   ", pressure);
 		LCD_GFX_drawString(160, LCD_HEIGHT >> 1, buffer, GREEN, BLACK, 3);
@@ -40,45 +49,165 @@ void LCD_TouchScreen_test_paint() {
 	LCD_GFX_drawString(120,10, "PINTA!", MAGENTA, WHITE, 3);
     LCD_GFX_setRotation(0);
 	LCD_GFX_drawString(70, 5, "Salir", BLACK, RED, 2);
-	uint16_t x = 0, y = 0;
+	LCD_TouchScreen_event_t ev;
+	LCD_Stroke_t stroke;
 	uint8_t terminado = 0;
+	uint8_t pintando = 0;
+	LCD_TouchScreen_setFilter(5, 40, 1);
+	LCD_TouchScreen_startSampling(200);
     while (!terminado) {
-        if (LCD_TouchScreen_isTouched()) {
-			LCD_TouchScreen_readPosition(&x, &y);
+        // Procesar todas las muestras tomadas mientras se pintaba
+        while (!terminado && LCD_TouchScreen_getEvent(&ev)) {
+			if (ev.type == LCD_TOUCH_UP) {
+				if (pintando) LCD_Stroke_end(&stroke);
+				pintando = 0;
+				continue;
+			}
 			// Terminar sesion pintado
-			if(y < 30 && (x > 70 && x <150)) {
+			if(ev.y < 30 && (ev.x >= 70 && ev.x < 130)) {
 				terminado = 1;
 			}
-			// Pintar normal
+			// Pintar normal, uniendo las muestras con un trazo suavizado
 			else {
-				LCD_GFX_fillRect(LCD_WIDTH - x, y, 5, 5, BLUE);
+				if (!pintando) {
+					LCD_Stroke_begin(&stroke, NULL, 0, BLUE, 5);
+					pintando = 1;
+				}
+				LCD_LATENCY_DRAW_BEGIN(&ev);
+				LCD_Stroke_addPoint(&stroke, ev.x, ev.y);
+				LCD_LATENCY_DRAW_END();
 			}
         }
+        __WFE();
     }
+	LCD_TouchScreen_stopSampling();
+	while (LCD_TouchScreen_getEvent(&ev));
+	LCD_LATENCY_REPORT();
 	LCD_GFX_fillScreen(BLACK);
 }
 
 void LCD_TouchScreen_test_calibrate() {
-	uint16_t min_x, min_y, max_x, max_y;
+	LCD_TouchScreen_calibration_t cal;
 	char buff [100];
-	LCD_GFX_fillScreen(BLACK);
-	LCD_GFX_drawString(0, LCD_HEIGHT >> 1, "Toca los cuadrados", GREEN, BLACK, 2);
-	
-	LCD_GFX_fillRect(0, 0, 10, 10, RED);
-	while (!LCD_TouchScreen_isTouched());
-	XPT2046_readPosition(&min_x, &min_y);
-	LCD_GFX_fillRect(0, 0, 10, 10, BLACK);
-	while (LCD_TouchScreen_isTouched())
-
-	nrf_delay_us(10000000);
-
-	LCD_GFX_fillRect(LCD_WIDTH - 10, LCD_HEIGHT - 10, 10, 10, RED);
-	while (!LCD_TouchScreen_isTouched());
-	XPT2046_readPosition(&max_x, &max_y);
-	LCD_GFX_fillRect(LCD_WIDTH - 10, LCD_HEIGHT - 10, 10, 10, BLACK);
-	
-
-	sprintf(buff, "MIN_X:%d\nMIN_Y:%d\nMAX_X:%d\nMAX_Y:%d", min_x, min_y, max_x, max_y);
+
+	if (!LCD_TouchScreen_calibrate()) {
+		LCD_GFX_fillScreen(BLACK);
+		LCD_GFX_drawString(0, LCD_HEIGHT >> 1, "Calibracion invalida", RED, BLACK, 2);
+		return;
+	}
+
+	// Mostrar la matriz obtenida (Q16.16)
+	LCD_TouchScreen_getCalibration(&cal);
+	sprintf(buff, "A:%ld\nB:%ld\nC:%ld\nD:%ld\nE:%ld\nF:%ld",
+			(long)cal.a, (long)cal.b, (long)cal.c, (long)cal.d, (long)cal.e, (long)cal.f);
 	LCD_GFX_fillScreen(BLACK);
 	LCD_GFX_drawString(0, LCD_HEIGHT >> 2, buff, WHITE, BLACK, 2);
 }
+
+void LCD_TouchScreen_test_gestures() {
+	static const char *names[] = {
+		"TAP", "DOUBLE TAP", "LONG PRESS", "DRAG START", "DRAG", "DRAG END", "SWIPE", "FLING"
+	};
+	LCD_TouchScreen_event_t ev;
+	LCD_Gesture_event_t gesture;
+	int16_t page = 0;
+	char buffer[40];
+
+	LCD_GFX_setRotation(0);
+	LCD_GFX_fillScreen(BLACK);
+	LCD_GFX_drawString(0, 10, "Pagina 0", WHITE, BLACK, 3);
+	LCD_Gesture_init(NULL);
+	LCD_TouchScreen_startSampling(200);
+	while (1) {
+		while (LCD_TouchScreen_getEvent(&ev)) {
+			LCD_Gesture_feed(&ev);
+		}
+		LCD_Gesture_poll(LCD_TouchScreen_millis());
+
+		while (LCD_Gesture_getEvent(&gesture)) {
+			// Los swipes horizontales cambian de pagina
+			if ((gesture.type == LCD_GESTURE_SWIPE || gesture.type == LCD_GESTURE_FLING) &&
+				(gesture.direction == LCD_GESTURE_LEFT || gesture.direction == LCD_GESTURE_RIGHT)) {
+				page += gesture.direction == LCD_GESTURE_LEFT ? 1 : -1;
+				sprintf(buffer, "Pagina %d  ", page);
+				LCD_GFX_drawString(0, 10, buffer, WHITE, BLACK, 3);
+			}
+			if (gesture.type == LCD_GESTURE_DRAG) continue;
+			sprintf(buffer, "%-10s\nv=%d,%d      ", names[gesture.type], gesture.vx, gesture.vy);
+			LCD_GFX_drawString(0, LCD_HEIGHT >> 1, buffer, GREEN, BLACK, 2);
+		}
+		__WFE();
+	}
+}
+
+// Grabacion en RAM: con NRF_LOG_DEFERRED a 0 cada linea se formatea y se envia
+// dentro de la interrupcion de muestreo, asi que se guarda y se envia al terminar
+#ifndef LCD_TOUCH_TEST_RECORDS
+#define LCD_TOUCH_TEST_RECORDS 2048     // Entradas (unas 3 por periodo de muestreo con lapiz)
+#endif
+#ifndef LCD_TOUCH_TEST_SAMPLES
+#define LCD_TOUCH_TEST_SAMPLES 6144     // Muestras (unas 6 por periodo), ~5 s de trazo a 200 Hz
+#endif
+
+static struct {
+	XPT2046_record_t records[LCD_TOUCH_TEST_RECORDS];
+	XPT2046_sample_t samples[LCD_TOUCH_TEST_SAMPLES];
+	uint32_t count;			// Entradas guardadas
+	uint32_t used;			// Muestras guardadas
+	uint32_t dropped;		// Entradas que no cabian
+} recording;
+
+/**
+ * @brief Guarda cada lectura del tactil en `recording`. Al llenarse deja de grabar.
+ */
+static void LCD_TouchScreen_test_recorder(const XPT2046_sample_t *samples, uint8_t n, bool pen) {
+	if (recording.dropped > 0 || recording.count == LCD_TOUCH_TEST_RECORDS ||
+	    recording.used + n > LCD_TOUCH_TEST_SAMPLES) {
+		recording.dropped++;
+		return;
+	}
+
+	XPT2046_record_t *r = &recording.records[recording.count++];
+	r->time = LCD_TouchScreen_millis();
+	r->first = recording.used;
+	r->n = n;
+	r->pen = pen;
+	for (uint8_t i = 0; i < n; i++) {
+		recording.samples[recording.used++] = samples[i];
+	}
+}
+
+/**
+ * @brief Envia la grabacion por NRF_LOG en el formato de tools/touch_replay.py.
+ */
+static void LCD_TouchScreen_test_dumpRecording() {
+	for (uint32_t i = 0; i < recording.count; i++) {
+		const XPT2046_record_t *r = &recording.records[i];
+		NRF_LOG_INFO("R %u %u %u", r->time, r->pen, r->n);
+		for (uint8_t j = 0; j < r->n; j++) {
+			const XPT2046_sample_t *s = &recording.samples[r->first + j];
+			NRF_LOG_INFO("S %u %u %u %u", s->x, s->y, s->z1, s->z2);
+		}
+	}
+	if (recording.dropped > 0) {
+		NRF_LOG_WARNING("Grabacion llena: %u entradas sin guardar", recording.dropped);
+	}
+}
+
+void LCD_TouchScreen_test_record() {
+	recording.count = 0;
+	recording.used = 0;
+	recording.dropped = 0;
+
+	XPT2046_setRecorder(LCD_TouchScreen_test_recorder);
+	LCD_TouchScreen_test_paint();
+	XPT2046_setRecorder(NULL);
+
+	LCD_TouchScreen_test_dumpRecording();
+}
+
+void LCD_TouchScreen_test_replay(const XPT2046_session_t *session) {
+	XPT2046_startReplay(session);
+	LCD_TouchScreen_test_paint();
+	XPT2046_startReplay(NULL);
+}
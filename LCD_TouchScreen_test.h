@@ -18,6 +18,8 @@
 #ifndef LCD_TOUCHSCREEN_TEST_H
 #define LCD_TOUCHSCREEN_TEST_H
 
+#include "XPT2046.h"
+
 /**
  * @brief Muestra una pantalla roja si no detecta una pulsacion en 
  * la pantalla y de otra forma muestra una pantalla verde.
@@ -30,7 +32,30 @@ void LCD_TouchScreen_test_pressure(void);
 void LCD_TouchScreen_test_paint(void);
 
 /**
- * @brief Test para hayar los valores de calibracion de la pantalla
+ * @brief Calibra la pantalla tocando tres cruces y muestra la matriz resultante.
  */
 void LCD_TouchScreen_test_calibrate(void);
+
+/**
+ * @brief Muestra los gestos reconocidos. Los swipes horizontales cambian de página.
+ */
+void LCD_TouchScreen_test_gestures(void);
+
+/**
+ * @brief Ejecuta el test de pintado grabando las lecturas del táctil.
+ * 
+ * Las lecturas se guardan en RAM (hasta LCD_TOUCH_TEST_RECORDS entradas y
+ * LCD_TOUCH_TEST_SAMPLES muestras) y se envían por NRF_LOG al salir del test.
+ * El log se convierte en una sesión reproducible con tools/touch_replay.py.
+ * @note NRF_LOG debe estar inicializado (main.c lo hace).
+ */
+void LCD_TouchScreen_test_record(void);
+
+/**
+ * @brief Ejecuta el test de pintado con una sesión grabada en lugar del panel.
+ * 
+ * La misma sesión dibuja siempre lo mismo, por lo que sirve como prueba de
+ * regresión de la calibración, los filtros y el trazo, y para medir tiempos.
+ */
+void LCD_TouchScreen_test_replay(const XPT2046_session_t *session);
 #endif
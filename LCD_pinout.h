@@ -12,6 +12,7 @@
 
 // TOUCH
  #define TOUCH_CS 40
+#define TOUCH_IRQ 41   // PENIRQ del XPT2046, activo a nivel bajo
 
 // LCD
 #define LCD_RESET 43
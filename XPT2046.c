@@ -15,95 +15,305 @@
  *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
  * @see         XPT2046.h
  */
-#include "nrfx_spi.h"
 #include "nrf_gpio.h"
-#include "nrf_delay.h"
+#include "nrfx_gpiote.h"
 #include "XPT2046.h"
+#include "LCD_SPI.h"
+#include "LCD_Latency.h"
 #include "LCD_pinout.h"
 
-#define SPI_INSTANCE 0
-static const nrfx_spi_t spi = NRFX_SPI_INSTANCE(SPI_INSTANCE);
+// Controlador de LCD_pinout.h, seleccionado al arrancar
+static XPT2046_t default_device = XPT2046_DEVICE(TOUCH_CS, TOUCH_IRQ);
+
+// Controlador seleccionado con XPT2046_bind
+static XPT2046_t *dev = &default_device;
+
+// Controladores con PENIRQ activado, para saber a quien va cada interrupcion
+static XPT2046_t *irq_devices[XPT2046_MAX_DEVICES];
 
 /**
  * @brief Inicializa el pin de selección de chip (CS) del controlador táctil XPT2046.
  */
 static void XPT2046_gpio_init() {
-    nrf_gpio_pin_dir_set(TOUCH_CS, NRF_GPIO_PIN_DIR_OUTPUT);
-    nrf_gpio_pin_write(TOUCH_CS, 1);
+    nrf_gpio_pin_dir_set(dev->cs_pin, NRF_GPIO_PIN_DIR_OUTPUT);
+    nrf_gpio_pin_write(dev->cs_pin, 1);
 }
 
+
 /**
- * @brief Inicializa el periférico SPI para la comunicación con el XPT2046.
+ * @brief Envía una secuencia de comandos al XPT2046 en una sola transacción y lee sus resultados.
+ * 
+ * Usa el modo de 16 ciclos por conversión: el byte de comando de cada conversión se
+ * envía a la vez que el último byte del resultado de la anterior, por lo que `n`
+ * conversiones ocupan 2n+1 bytes con el CS bajo todo el tiempo y sin esperas.
+ * 
+ * @param cmds Comandos a enviar.
+ * @param n Número de comandos (máximo XPT2046_MAX_CONVERSIONS).
+ * @param values Valores de 12 bits leídos, uno por comando.
  */
-static void XPT2046_spi_init() {
-    nrfx_spi_config_t spi_config = NRFX_SPI_DEFAULT_CONFIG;
-    spi_config.sck_pin  = SPI_SCK_PIN;
-    spi_config.mosi_pin = SPI_MOSI_PIN;
-    spi_config.miso_pin = SPI_MISO_PIN;
-    spi_config.ss_pin   = NRFX_SPI_PIN_NOT_USED;
-    spi_config.frequency = NRF_SPI_FREQ_4M;
-    spi_config.mode = NRF_SPI_MODE_0;
-    spi_config.bit_order = NRF_SPI_BIT_ORDER_MSB_FIRST;
-    
-    nrfx_spi_init(&spi, &spi_config, NULL, NULL);
-}
+static void XPT2046_readData(const uint8_t *cmds, uint8_t n, uint16_t *values) {
+    uint8_t tx_buffer[2 * XPT2046_MAX_CONVERSIONS + 1] = {0};
+    uint8_t rx_buffer[2 * XPT2046_MAX_CONVERSIONS + 1];
+    uint16_t len = 2 * n + 1;
 
+    // El ADC sigue encendido entre las conversiones de la rafaga y se apaga con la
+    // ultima, que vuelve a habilitar PENIRQ. La referencia interna no se usa nunca
+    // (modo diferencial), por lo que tampoco se enciende.
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t pd = (i == n - 1) ? XPT2046_PD_POWER_DOWN : XPT2046_PD_ADC_ON;
+        tx_buffer[2 * i] = (cmds[i] & ~XPT2046_PD_MASK) | pd;
+    }
+
+    // PENIRQ cambia durante la conversion, se ignora mientras tanto
+    if (dev->penirq_handler) nrfx_gpiote_in_event_disable(dev->irq_pin);
+
+    LCD_SPI_acquire();
+    LCD_SPI_setFrequency(dev->frequency);
+    nrf_gpio_pin_write(dev->cs_pin, 0);
+    LCD_SPI_xfer(tx_buffer, len, rx_buffer, len);
+    nrf_gpio_pin_write(dev->cs_pin, 1);
+    LCD_SPI_release();
+    LCD_LATENCY_SAMPLE();
+
+    if (dev->penirq_handler) nrfx_gpiote_in_event_enable(dev->irq_pin, true);
+
+    // El resultado de cada comando llega en los dos bytes siguientes, quedarse con los 12 bits utiles
+    for (uint8_t i = 0; i < n; i++) {
+        values[i] = ((rx_buffer[2 * i + 1] << 8) | rx_buffer[2 * i + 2]) >> 3;
+    }
+}
 
 /**
- * @brief Envía un comando al XPT2046 y lee el valor de 12 bits de su respuesta.
- * 
- * Envía el byte de comando seguido de dos bytes vacíos para recibir la respuesta.
+ * @brief Devuelve la siguiente lectura de la sesion en reproduccion.
  * 
- * @param cmd Comando a enviar al XPT2046.
- * @return Valor de 12 bits leído del controlador táctil.
+ * Si la entrada actual no es una lectura (cambio de PENIRQ) se devuelven muestras
+ * sin toque y no se avanza.
  */
-static uint16_t XPT2046_readData(uint8_t cmd) {
-    // 1 byte de comando y 2 de respuesta
-    uint8_t tx_buffer[3] = {cmd, 0x00, 0x00};
-    uint8_t rx_buffer[3] = {0};
+static void XPT2046_replaySamples(XPT2046_sample_t *samples, uint8_t n) {
+    const XPT2046_session_t *s = dev->replay.session;
+    const XPT2046_record_t *r = dev->replay.index < s->count ? &s->records[dev->replay.index] : NULL;
 
-    nrf_gpio_pin_write(TOUCH_CS, 0);
-    nrfx_spi_xfer_desc_t xfer = NRFX_SPI_XFER_TRX(tx_buffer, 3, rx_buffer, 3);
-    nrfx_spi_xfer(&spi, &xfer, 0);
-    nrf_gpio_pin_write(TOUCH_CS, 1);
+    if (r == NULL || r->n == 0) {
+        for (uint8_t i = 0; i < n; i++) {
+            samples[i] = (XPT2046_sample_t){0};
+        }
+        return;
+    }
 
-    // Devolver solo los 12 bits utiles
-    return ((rx_buffer[1] << 8) | rx_buffer[2]) >> 3;
+    // Si se piden mas muestras de las grabadas se repite la ultima
+    for (uint8_t i = 0; i < n; i++) {
+        samples[i] = s->samples[r->first + (i < r->n ? i : r->n - 1)];
+    }
+    dev->replay.time = r->time;
+    dev->replay.index++;
 }
 
 /**
- * @brief Realiza múltiples lecturas de un comando del XPT2046 y devuelve el valor promedio.
+ * @brief Nivel de PENIRQ de la sesion en reproduccion.
  * 
- * Lee el valor correspondiente al comando `cmd` varias veces (definido por `SAMPLES`)
- * y devuelve la media aritmética. Esto reduce el ruido y mejora la precisión.
- * 
- * @param cmd Comando a enviar al XPT2046.
- * @return Valor promedio de las lecturas.
+ * Los cambios de PENIRQ se consumen de uno en uno en cada consulta; mientras la
+ * siguiente entrada es una lectura, el lapiz esta apoyado.
+ */
+static bool XPT2046_replayPen(void) {
+    const XPT2046_session_t *s = dev->replay.session;
+
+    if (dev->replay.index >= s->count) {
+        dev->replay.session = NULL;     // Fin de la sesion, volver al panel
+        return false;
+    }
+
+    const XPT2046_record_t *r = &s->records[dev->replay.index];
+    if (r->n == 0) {
+        dev->replay.time = r->time;
+        dev->replay.index++;
+    }
+    return r->pen;
+}
+
+void XPT2046_readSamples(XPT2046_sample_t *samples, uint8_t n) {
+    static const uint8_t set[4] = {XPT2046_CMD_X, XPT2046_CMD_Y, XPT2046_CMD_Z1, XPT2046_CMD_Z2};
+    uint8_t cmds[XPT2046_MAX_CONVERSIONS];
+    uint16_t values[XPT2046_MAX_CONVERSIONS];
+
+    if (n > XPT2046_MAX_SAMPLES) n = XPT2046_MAX_SAMPLES;
+    if (dev->replay.session) {
+        XPT2046_replaySamples(samples, n);
+        return;
+    }
+
+    for (uint8_t i = 0; i < 4 * n; i++) {
+        cmds[i] = set[i & 0x3];
+    }
+
+    XPT2046_readData(cmds, 4 * n, values);
+
+    for (uint8_t i = 0; i < n; i++) {
+        samples[i].x  = values[4 * i];
+        samples[i].y  = values[4 * i + 1];
+        samples[i].z1 = values[4 * i + 2];
+        samples[i].z2 = values[4 * i + 3];
+    }
+
+    if (dev->recorder) dev->recorder(samples, n, true);
+}
+
+/**
+ * @brief Presión a partir de las medidas X, Z1 y Z2 de una muestra.
+ */
+static uint16_t XPT2046_pressure(uint16_t x, uint16_t z1, uint16_t z2) {
+    if(z1 == 0 || z2 == 0 || z1 >= z2) return 0;  // Resultados invalidos
+
+    // R = Rx * x / 4096 * (z2 - z1) / z1, repartiendo los desplazamientos para no desbordar
+    uint32_t r = (((uint32_t)XPT2046_X_PLATE_OHMS * x) >> 4) * (z2 - z1) / ((uint32_t)z1 << 8);
+    return (uint16_t)(4095UL * XPT2046_PRESSURE_REF_OHMS / (XPT2046_PRESSURE_REF_OHMS + r));
+}
+
+/**
+ * @brief Ordena los valores de menor a mayor (insercion, n es pequeño).
+ */
+static void XPT2046_sort(uint16_t *v, uint8_t n) {
+    for (uint8_t i = 1; i < n; i++) {
+        uint16_t key = v[i];
+        int8_t j = i - 1;
+        while (j >= 0 && v[j] > key) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = key;
+    }
+}
+
+/**
+ * @brief Mediana de `n` valores ordenados.
  */
-#define SAMPLES 5
-static uint16_t XPT2046_readFiltered(uint8_t cmd) {
-    uint32_t sum = 0;
-    for (uint8_t i = 0; i < SAMPLES; i++) {
-        sum += XPT2046_readData(cmd);
-        nrf_delay_us(100); // Peque�o delay entre lecturas
+static uint16_t XPT2046_median(const uint16_t *v, uint8_t n) {
+    return (n & 1) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+/**
+ * @brief Dispersion de los valores ordenados sin la cuarta parte mas baja y la mas alta.
+ */
+static uint16_t XPT2046_spread(const uint16_t *v, uint8_t n) {
+    uint8_t k = n / 4;
+    return v[n - 1 - k] - v[k];
+}
+
+bool XPT2046_readPosition(uint16_t *x, uint16_t *y) {
+    XPT2046_sample_t samples[XPT2046_MAX_SAMPLES];
+    uint16_t vx[XPT2046_MAX_SAMPLES], vy[XPT2046_MAX_SAMPLES];
+    uint8_t n = dev->filter.samples;
+
+    // Todas las muestras en una sola transaccion
+    XPT2046_readSamples(samples, n);
+    for (uint8_t i = 0; i < n; i++) {
+        vx[i] = samples[i].x;
+        vy[i] = samples[i].y;
     }
-    return sum / SAMPLES;
+    XPT2046_sort(vx, n);
+    XPT2046_sort(vy, n);
+
+    *x = XPT2046_median(vx, n);
+    *y = XPT2046_median(vy, n);
+
+    uint16_t max_spread = dev->filter.max_spread;
+    if (max_spread == 0) return true;
+    return XPT2046_spread(vx, n) <= max_spread && XPT2046_spread(vy, n) <= max_spread;
 }
 
-void XPT2046_readPosition(uint16_t *x, uint16_t *y) {
-    *x = XPT2046_readFiltered(XPT2046_CMD_X);
-    *y = XPT2046_readFiltered(XPT2046_CMD_Y);
+void XPT2046_setFilter(const XPT2046_filter_t *config) {
+    XPT2046_filter_t *filter = &dev->filter;
+    *filter = *config;
+    if (filter->samples == 0) filter->samples = 1;
+    if (filter->samples > XPT2046_MAX_SAMPLES) filter->samples = XPT2046_MAX_SAMPLES;
 }
 
 uint16_t XPT2046_readPressure() {
-    uint16_t z1 = XPT2046_readData(XPT2046_CMD_Z1);
-    uint16_t z2 = XPT2046_readData(XPT2046_CMD_Z2);
+    XPT2046_sample_t sample;
+    XPT2046_readSamples(&sample, 1);
+    return XPT2046_pressure(sample.x, sample.z1, sample.z2);
+}
 
-    if(z1 == 0 || z2 == 0 || z1 >= z2) return 0;  // Resultados invalidos
+/**
+ * @brief Rutina de atencion del flanco de bajada de PENIRQ.
+ */
+static void XPT2046_penirq_isr(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action) {
+    for (uint8_t i = 0; i < XPT2046_MAX_DEVICES; i++) {
+        XPT2046_t *d = irq_devices[i];
+        if (d && d->irq_pin == pin && d->penirq_handler) d->penirq_handler();
+    }
+}
+
+void XPT2046_enablePenIrq(XPT2046_penirq_handler_t handler) {
+    // Registrar el controlador para la rutina de atencion
+    uint8_t slot = XPT2046_MAX_DEVICES;
+    for (uint8_t i = 0; i < XPT2046_MAX_DEVICES; i++) {
+        if (irq_devices[i] == dev) {
+            slot = i;
+            break;
+        }
+        if (irq_devices[i] == NULL && slot == XPT2046_MAX_DEVICES) slot = i;
+    }
+    if (slot == XPT2046_MAX_DEVICES) return;
 
-    return (z1 + 4095 - z2);
+    if (!nrfx_gpiote_is_init()) {
+        nrfx_gpiote_init();
+    }
+
+    // PENIRQ es de drenador abierto, necesita pull-up
+    if (irq_devices[slot] == NULL) {
+        nrfx_gpiote_in_config_t config = NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(true);
+        config.pull = NRF_GPIO_PIN_PULLUP;
+        nrfx_gpiote_in_init(dev->irq_pin, &config, XPT2046_penirq_isr);
+        irq_devices[slot] = dev;
+    }
+
+    dev->penirq_handler = handler;
+    nrfx_gpiote_in_event_enable(dev->irq_pin, true);
 }
+
+bool XPT2046_isPenDown() {
+    if (dev->replay.session) return XPT2046_replayPen();
+
+    bool pen = nrf_gpio_pin_read(dev->irq_pin) == 0;
+    if (dev->recorder && pen != dev->recorded_pen) {
+        dev->recorded_pen = pen;
+        dev->recorder(NULL, 0, pen);
+    }
+    return pen;
+}
+
+void XPT2046_setRecorder(XPT2046_recorder_t handler) {
+    dev->recorded_pen = false;
+    dev->recorder = handler;
+}
+
+void XPT2046_startReplay(const XPT2046_session_t *session) {
+    dev->replay.index = 0;
+    dev->replay.time = 0;
+    dev->replay.session = (session && session->count > 0) ? session : NULL;
+}
+
+bool XPT2046_getReplayTime(uint32_t *time) {
+    if (dev->replay.session == NULL) return false;
+    if (time) *time = dev->replay.time;
+    return true;
+}
+
+void XPT2046_bind(XPT2046_t *device) {
+    dev = device ? device : &default_device;
+}
+
+XPT2046_t *XPT2046_getDevice(void) {
+    return dev;
+}
+
 void XPT2046_init() {
+    uint16_t value;
+    const uint8_t cmd = XPT2046_CMD_Z1;
+
     XPT2046_gpio_init();
-    XPT2046_spi_init();
+    LCD_SPI_init();
+
+    // Una conversion con PD = 00 deja el ADC apagado y PENIRQ activo desde el arranque
+    XPT2046_readData(&cmd, 1, &value);
 }
@@ -20,6 +20,8 @@
 #define XPT2046_h
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "LCD_SPI.h"
 
 #define XPT2046_CMD_X  0xD0 // X
 #define XPT2046_CMD_Y  0x90  // Y
@@ -27,24 +29,219 @@
 #define XPT2046_CMD_Z1 0xB0  // Z1
 #define XPT2046_CMD_Z2 0xC0  // Z2
 
+// Bits de apagado (PD1-PD0) del byte de comando. Los comandos anteriores usan
+// XPT2046_PD_POWER_DOWN: ADC y referencia apagados entre conversiones y PENIRQ activo.
+#define XPT2046_PD_POWER_DOWN 0x00  // Apagado entre conversiones, PENIRQ activo
+#define XPT2046_PD_ADC_ON     0x01  // ADC encendido, referencia interna apagada, sin PENIRQ
+#define XPT2046_PD_MASK       0x03
+
+// Resistencia de la lamina X del panel (ohmios), ver XPT2046_readPressure
+#define XPT2046_X_PLATE_OHMS 400
+// Resistencia de toque que corresponde a la mitad de la escala de presion
+#define XPT2046_PRESSURE_REF_OHMS 400
+
+// Reloj SPI por defecto, la hoja de datos admite hasta 2.5 MHz
+#define XPT2046_SPI_FREQUENCY LCD_SPI_FREQ_2M
+
+// Maximo de controladores con PENIRQ activado a la vez
+#define XPT2046_MAX_DEVICES 2
+
+// Maximo de muestras (X, Y, Z1, Z2) por transaccion
+#define XPT2046_MAX_SAMPLES 8
+#define XPT2046_MAX_CONVERSIONS (4 * XPT2046_MAX_SAMPLES)
+
+/**
+ * @brief Muestra completa del táctil, valores en crudo en el rango [0, 4095].
+ */
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t z1;
+    uint16_t z2;
+} XPT2046_sample_t;
+
+/**
+ * @brief Configuración del filtrado de la posición.
+ * 
+ * Cada lectura toma `samples` muestras en una sola transacción y se queda con la
+ * mediana de cada eje. Si la dispersión de las muestras centrales (descartando la
+ * cuarta parte más baja y la más alta) supera `max_spread` en algún eje, la
+ * lectura se rechaza: suele ocurrir al apoyar o levantar el lápiz.
+ */
+typedef struct {
+    uint8_t samples;        // Muestras por lectura, [1, XPT2046_MAX_SAMPLES]. Mejor impar.
+    uint16_t max_spread;    // Dispersión máxima en valores crudos, 0 para no rechazar nunca
+} XPT2046_filter_t;
+
+#define XPT2046_FILTER_DEFAULT { .samples = 5, .max_spread = 40 }
+
+/**
+ * @brief Función a la que se llama (desde interrupción) cuando se detecta un toque.
+ */
+typedef void (*XPT2046_penirq_handler_t)(void);
+
+/**
+ * @brief Función que recibe las lecturas para grabarlas.
+ * 
+ * Se llama con cada lectura por SPI (`n` muestras, `pen` a true) y con cada cambio
+ * del nivel de PENIRQ visto por XPT2046_isPenDown (`samples` NULL y `n` a 0).
+ */
+typedef void (*XPT2046_recorder_t)(const XPT2046_sample_t *samples, uint8_t n, bool pen);
+
+/**
+ * @brief Entrada de una sesión grabada: una lectura o un cambio de PENIRQ.
+ */
+typedef struct {
+    uint32_t time;          // Instante en ms
+    uint32_t first;         // Índice de la primera muestra en XPT2046_session_t.samples
+    uint8_t n;              // Muestras de la lectura, 0 si es un cambio de PENIRQ
+    uint8_t pen;            // Nivel de PENIRQ (1 = lápiz apoyado)
+} XPT2046_record_t;
+
+/**
+ * @brief Sesión grabada para reproducir (ver tools/touch_replay.py).
+ */
+typedef struct {
+    const XPT2046_record_t *records;
+    uint32_t count;
+    const XPT2046_sample_t *samples;
+} XPT2046_session_t;
+
+/**
+ * @brief Contexto de un controlador táctil.
+ * 
+ * Los pines y la frecuencia se rellenan con XPT2046_DEVICE antes de llamar a
+ * XPT2046_bind (la frecuencia puede cambiarse después); el resto de campos
+ * son internos. Todos los controladores comparten el bus de LCD_SPI, cada uno
+ * con su CS.
+ */
+typedef struct {
+    // Pines
+    uint8_t cs_pin;
+    uint8_t irq_pin;                            // PENIRQ
+    LCD_SPI_frequency_t frequency;              // Reloj SPI de las lecturas
+
+    XPT2046_filter_t filter;
+    XPT2046_penirq_handler_t penirq_handler;
+
+    // Grabacion de las lecturas
+    XPT2046_recorder_t recorder;
+    bool recorded_pen;
+
+    // Reproduccion de una sesion grabada
+    struct {
+        const XPT2046_session_t *session;       // NULL si se usa el panel
+        uint32_t index;                         // Siguiente entrada
+        uint32_t time;                          // Instante de la ultima entrada reproducida
+    } replay;
+} XPT2046_t;
+
+// Inicializador de un XPT2046_t con sus pines
+#define XPT2046_DEVICE(cs, irq) { .cs_pin = (cs), .irq_pin = (irq), .frequency = XPT2046_SPI_FREQUENCY, \
+                                  .filter = XPT2046_FILTER_DEFAULT }
+
 /**
- * @brief Inicializa el controlador del XPT2046
+ * @brief Selecciona el controlador sobre el que actúan el resto de funciones del módulo.
+ * 
+ * Al arrancar está seleccionado el de LCD_pinout.h. El muestreo de LCD_TouchScreen
+ * lee el controlador seleccionado, por lo que solo debe cambiarse con el muestreo
+ * parado y desde el programa principal.
+ * 
+ * @param dev Controlador a seleccionar, o NULL para volver al de LCD_pinout.h.
+ */
+void XPT2046_bind(XPT2046_t *dev);
+
+/**
+ * @brief Devuelve el controlador seleccionado.
+ */
+XPT2046_t *XPT2046_getDevice(void);
+
+/**
+ * @brief Inicializa el controlador del XPT2046 seleccionado
  * @note Esta funcion debe ser llamada antes de cualquier otra de este módulo.
  */
 void XPT2046_init(void);
 
 /**
- * @brief Lee y procesa, aplicando un algoritmo de anti-aliasing de 3 muestras, la posición de donde está siendo tocada la pantalla
+ * @brief Activa la interrupción de toque (PENIRQ) a través del GPIOTE.
+ * 
+ * El XPT2046 baja PENIRQ cuando se toca el panel estando en reposo entre
+ * conversiones. Durante las lecturas por SPI la interrupción se enmascara, ya que
+ * las conversiones también hacen variar la línea. Pueden tener la interrupción
+ * activada a la vez hasta XPT2046_MAX_DEVICES controladores.
+ * 
+ * @param handler Función a la que se llama en cada flanco de bajada de PENIRQ.
+ */
+void XPT2046_enablePenIrq(XPT2046_penirq_handler_t handler);
+
+/**
+ * @brief Indica si el lápiz está apoyado según el nivel de PENIRQ, sin usar el SPI.
+ * @return true si PENIRQ está a nivel bajo.
+ */
+bool XPT2046_isPenDown(void);
+
+/**
+ * @brief Lee y procesa, con el filtro de mediana configurado, la posición de donde está siendo tocada la pantalla
  * @param x Puntero a la variable donde se almacenará X (valor en crudo, rango [0, 4095])
  * @param y Puntero a la variable donde se almacenará Y (valor en crudo, rango [0, 4095])
+ * @return false si la lectura se ha rechazado por tener demasiada dispersión. Aun así
+ *         se devuelve la mediana en `x` e `y`.
  */
-void XPT2046_readPosition(uint16_t *x, uint16_t *y);
+bool XPT2046_readPosition(uint16_t *x, uint16_t *y);
+
+/**
+ * @brief Cambia la configuración del filtrado de la posición.
+ * @param filter Nueva configuración (ver XPT2046_FILTER_DEFAULT).
+ */
+void XPT2046_setFilter(const XPT2046_filter_t *filter);
+
+/**
+ * @brief Lee `n` muestras completas (X, Y, Z1 y Z2) en una sola transacción SPI.
+ * 
+ * Las conversiones se solapan (16 ciclos de reloj por conversión) y no hay esperas
+ * entre ellas: una muestra completa son 9 bytes, unos 36 µs a 2 MHz.
+ * 
+ * @param samples Array donde se guardarán las muestras.
+ * @param n Número de muestras a leer (máximo XPT2046_MAX_SAMPLES).
+ */
+void XPT2046_readSamples(XPT2046_sample_t *samples, uint8_t n);
 
 /**
  * @brief Mide la presión del toque actual.
- * @return Valor de presión, rango [0-4095].
+ * 
+ * Calcula la resistencia del punto de contacto con la fórmula de la hoja de datos,
+ * R = Rx * X / 4096 * (Z2 / Z1 - 1), que no depende de dónde se toque, y la
+ * normaliza como 4095 * Rref / (Rref + R): cuanto más fuerte el toque, menor es R
+ * y mayor la presión.
+ * 
+ * @return Valor de presión, rango [0-4095]. 0 si no hay toque.
  */
 uint16_t XPT2046_readPressure(void);
 
+/**
+ * @brief Graba las lecturas del táctil llamando a `recorder`.
+ * @param recorder Función que recibe las lecturas, o NULL para dejar de grabar.
+ */
+void XPT2046_setRecorder(XPT2046_recorder_t recorder);
+
+/**
+ * @brief Sustituye el panel por una sesión grabada.
+ * 
+ * Cada lectura devuelve la siguiente lectura grabada y XPT2046_isPenDown el nivel
+ * de PENIRQ grabado, de forma que la misma sesión produce siempre los mismos
+ * eventos. Los periodos sin lápiz se recorren sin esperar; el tiempo de la sesión
+ * se consulta con XPT2046_getReplayTime. Al terminar la sesión se vuelve al panel.
+ * 
+ * @param session Sesión a reproducir, o NULL para parar.
+ */
+void XPT2046_startReplay(const XPT2046_session_t *session);
+
+/**
+ * @brief Indica si se está reproduciendo una sesión.
+ * @param time Si no es NULL, devuelve el instante de la última entrada reproducida en ms.
+ * @return true si hay una sesión en curso.
+ */
+bool XPT2046_getReplayTime(uint32_t *time);
+
 
 #endif
@@ -22,6 +22,12 @@
 #include "LCD_TouchScreen_test.h"
 
 #include "nrf_gpio.h"
+#include "nrf_drv_clock.h"
+#include "app_timer.h"
+#include "LCD_Latency.h"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_default_backends.h"
 
 #define BTN_LEFT 11
 #define BTN_DOWN 12
@@ -34,9 +40,20 @@ void buttons_init() {
     nrf_gpio_cfg_input(BTN_DOWN, NRF_GPIO_PIN_PULLUP);
     nrf_gpio_cfg_input(BTN_RIGHT, NRF_GPIO_PIN_PULLUP);
 }
+void timers_init() {
+	// app_timer necesita el reloj de baja frecuencia
+	nrf_drv_clock_init();
+	nrf_drv_clock_lfclk_request(NULL);
+	app_timer_init();
+}
 int main(void)
 {
   	// Inicializar los módulos
+	timers_init();
+	// Los histogramas de latencia y las grabaciones del tactil se envian por NRF_LOG (RTT)
+	NRF_LOG_INIT(NULL);
+	NRF_LOG_DEFAULT_BACKENDS_INIT();
+	LCD_LATENCY_INIT();
 	LCD_GFX_init();
 	LCD_TouchScreen_init();
 	buttons_init();
@@ -0,0 +1,207 @@
+/**
+ * @file        test_LCD_Dirty.c
+ * @brief       Pruebas en el ordenador del gestor de zonas modificadas.
+ *
+ * @author      Jorge Fernández Marín
+ * @date        Octubre de 2026
+ *
+ * @details     LCD_Dirty no depende del SDK de Nordic, así que se compila y se prueba
+ *              en el ordenador con `make -C tests`. Se comprueban los casos básicos
+ *              (contención, unión de vecinos, unión de la pareja más barata con el
+ *              conjunto lleno y recorte) y, con rectángulos aleatorios, que lo devuelto
+ *              cubre todo lo marcado sin salirse de la pantalla y que, mientras caben
+ *              todos, no cuesta más que enviarlos por separado. Al final se compara el
+ *              coste de los rectángulos obtenidos con el de una sola caja envolvente,
+ *              que es lo que se enviaba antes.
+ *
+ * @note        Este archivo fue creado como parte del proyecto "Diseño de shield PCDB para
+ *              un nRF52840DK" para la asignatura Laboratorio de sistemas empotrados 2025,
+ *              perteneciente al plan de estudios del itinerario Ingeniería Informática en Unizar.
+ * @see         LCD_Dirty.h
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LCD_Dirty.h"
+
+#define WIDTH  320
+#define HEIGHT 240
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: falla %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static bool rect_equals(const LCD_Dirty_rect_t *r, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    return r->x0 == x0 && r->y0 == y0 && r->x1 == x1 && r->y1 == y1;
+}
+
+static void test_contained(void) {
+    LCD_Dirty_t d;
+    LCD_Dirty_rect_t r;
+    LCD_Dirty_init(&d, WIDTH, HEIGHT, LCD_DIRTY_WINDOW_COST);
+
+    LCD_Dirty_add(&d, 10, 10, 50, 40);
+    LCD_Dirty_add(&d, 20, 20, 5, 5);
+    LCD_Dirty_add(&d, 10, 10, 50, 40);
+    CHECK(d.count == 1);
+    CHECK(LCD_Dirty_pop(&d, &r) && rect_equals(&r, 10, 10, 59, 49));
+    CHECK(LCD_Dirty_isEmpty(&d));
+}
+
+static void test_adjacent(void) {
+    LCD_Dirty_t d;
+    LCD_Dirty_rect_t r;
+    LCD_Dirty_init(&d, WIDTH, HEIGHT, LCD_DIRTY_WINDOW_COST);
+
+    // Uno al lado del otro: la caja no añade pixeles
+    LCD_Dirty_add(&d, 0, 0, 10, 10);
+    LCD_Dirty_add(&d, 10, 0, 10, 10);
+    CHECK(d.count == 1);
+    CHECK(LCD_Dirty_cost(&d) == 200 + LCD_DIRTY_WINDOW_COST);
+    CHECK(LCD_Dirty_pop(&d, &r) && rect_equals(&r, 0, 0, 19, 9));
+
+    // Separados por una columna de 10 pixeles, menos que una ventana
+    LCD_Dirty_add(&d, 0, 0, 10, 1);
+    LCD_Dirty_add(&d, 20, 0, 10, 1);
+    CHECK(d.count == 1);
+
+    // Lejos: la caja costaria mas que otra ventana
+    LCD_Dirty_clear(&d);
+    LCD_Dirty_add(&d, 0, 0, 10, 10);
+    LCD_Dirty_add(&d, 100, 100, 10, 10);
+    CHECK(d.count == 2);
+    CHECK(LCD_Dirty_cost(&d) == 200 + 2 * LCD_DIRTY_WINDOW_COST);
+}
+
+static void test_full(void) {
+    LCD_Dirty_t d;
+    LCD_Dirty_rect_t r;
+    LCD_Dirty_init(&d, WIDTH, HEIGHT, LCD_DIRTY_WINDOW_COST);
+
+    // Una fila de cuadrados separados, todos lejos entre si salvo los dos ultimos
+    for (uint8_t i = 0; i < LCD_DIRTY_MAX_RECTS - 1; i++) {
+        LCD_Dirty_add(&d, i * 40, 0, 10, 10);
+    }
+    LCD_Dirty_add(&d, (LCD_DIRTY_MAX_RECTS - 2) * 40 + 15, 0, 10, 10);
+    CHECK(d.count == LCD_DIRTY_MAX_RECTS);
+
+    // Uno mas, lejos de todos: se unen los dos mas cercanos y el nuevo queda aparte
+    LCD_Dirty_add(&d, 0, 200, 10, 10);
+    CHECK(d.count == LCD_DIRTY_MAX_RECTS);
+
+    bool pair = false, added = false;
+    while (LCD_Dirty_pop(&d, &r)) {
+        if (rect_equals(&r, (LCD_DIRTY_MAX_RECTS - 2) * 40, 0, (LCD_DIRTY_MAX_RECTS - 2) * 40 + 24, 9)) pair = true;
+        if (rect_equals(&r, 0, 200, 9, 209)) added = true;
+    }
+    CHECK(pair);
+    CHECK(added);
+}
+
+static void test_clip(void) {
+    LCD_Dirty_t d;
+    LCD_Dirty_rect_t r;
+    LCD_Dirty_init(&d, WIDTH, HEIGHT, LCD_DIRTY_WINDOW_COST);
+
+    LCD_Dirty_add(&d, 10, 10, 0, 10);
+    LCD_Dirty_add(&d, 10, 10, 10, 0);
+    LCD_Dirty_add(&d, 10, 10, -5, 10);
+    LCD_Dirty_add(&d, WIDTH, 0, 10, 10);
+    LCD_Dirty_add(&d, 0, -20, 10, 10);
+    CHECK(LCD_Dirty_isEmpty(&d));
+    CHECK(LCD_Dirty_cost(&d) == 0);
+
+    LCD_Dirty_add(&d, -5, HEIGHT - 5, 10, 10);
+    CHECK(LCD_Dirty_pop(&d, &r) && rect_equals(&r, 0, HEIGHT - 5, 4, HEIGHT - 1));
+}
+
+/**
+ * @brief Rectangulos aleatorios: cobertura, limites y coste frente a una sola caja.
+ */
+static void test_random(void) {
+    static uint8_t marked[HEIGHT][WIDTH];
+    uint64_t cost_dirty = 0, cost_bbox = 0, cost_none = 0;
+
+    srand(49);
+    for (int it = 0; it < 2000; it++) {
+        LCD_Dirty_t d;
+        LCD_Dirty_rect_t r;
+        LCD_Dirty_init(&d, WIDTH, HEIGHT, LCD_DIRTY_WINDOW_COST);
+        memset(marked, 0, sizeof(marked));
+
+        // La mitad de las vueltas con elementos pequeños (texto, iconos) y la otra con grandes
+        int n = rand() % 20 + 1;
+        int max_w = (it & 1) ? 10 : 60;
+        int max_h = (it & 1) ? 10 : 40;
+        int bx0 = WIDTH, by0 = HEIGHT, bx1 = -1, by1 = -1;
+        int added = 0;
+        uint64_t separate = 0;
+        for (int k = 0; k < n; k++) {
+            int x = rand() % (WIDTH + 20) - 10, y = rand() % (HEIGHT + 20) - 10;
+            int w = rand() % max_w + 1, h = rand() % max_h + 1;
+            LCD_Dirty_add(&d, x, y, w, h);
+            CHECK(d.count <= LCD_DIRTY_MAX_RECTS);
+
+            int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+            int x1 = x + w > WIDTH ? WIDTH - 1 : x + w - 1;
+            int y1 = y + h > HEIGHT ? HEIGHT - 1 : y + h - 1;
+            if (x0 > x1 || y0 > y1) continue;
+            for (int j = y0; j <= y1; j++) memset(&marked[j][x0], 1, x1 - x0 + 1);
+            separate += (x1 - x0 + 1) * (y1 - y0 + 1) + LCD_DIRTY_WINDOW_COST;
+            added++;
+            if (x0 < bx0) bx0 = x0;
+            if (y0 < by0) by0 = y0;
+            if (x1 > bx1) bx1 = x1;
+            if (y1 > by1) by1 = y1;
+        }
+        // Mientras caben todos, solo se une lo que abarata: nunca cuesta mas que enviarlos por separado
+        if (added <= LCD_DIRTY_MAX_RECTS) CHECK(LCD_Dirty_cost(&d) <= separate);
+        cost_dirty += LCD_Dirty_cost(&d);
+        cost_none += separate;
+        if (bx1 >= 0) cost_bbox += (bx1 - bx0 + 1) * (by1 - by0 + 1) + LCD_DIRTY_WINDOW_COST;
+
+        while (LCD_Dirty_pop(&d, &r)) {
+            CHECK(r.x0 >= 0 && r.y0 >= 0 && r.x1 < WIDTH && r.y1 < HEIGHT);
+            for (int j = r.y0; j <= r.y1; j++) memset(&marked[j][r.x0], 0, r.x1 - r.x0 + 1);
+        }
+        for (int j = 0; j < HEIGHT; j++) {
+            for (int i = 0; i < WIDTH; i++) {
+                if (marked[j][i]) {
+                    printf("vuelta %d: pixel (%d, %d) sin enviar\n", it, i, j);
+                    failures++;
+                    j = HEIGHT;
+                    break;
+                }
+            }
+        }
+    }
+
+    CHECK(cost_dirty <= cost_bbox);
+    printf("Coste en pixeles (2000 vueltas de 1 a 20 rectangulos):\n");
+    printf("  LCD_Dirty:       %llu\n", (unsigned long long)cost_dirty);
+    printf("  caja envolvente: %llu (%.2fx)\n", (unsigned long long)cost_bbox, (double)cost_bbox / cost_dirty);
+    printf("  sin unir:        %llu (%.2fx)\n", (unsigned long long)cost_none, (double)cost_none / cost_dirty);
+    printf("  (sin unir sale mas barato porque no tiene limite de rectangulos: con mas de\n"
+           "   %d, LCD_Dirty tiene que unir parejas aunque la caja cueste mas que una ventana)\n",
+           LCD_DIRTY_MAX_RECTS);
+}
+
+int main(void) {
+    test_contained();
+    test_adjacent();
+    test_full();
+    test_clip();
+    test_random();
+
+    if (failures) {
+        printf("%d comprobaciones fallidas\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+Informe de tamaño de los recursos graficos (bitmaps.c) en el firmware.
+
+Lee la tabla de simbolos del ELF con `nm` y muestra, para cada recurso definido
+en bitmaps.c, su tamaño y si esta en flash (.rodata) o en RAM (.data/.bss).
+Devuelve un codigo de error si algun recurso ha acabado en RAM, por lo que
+puede usarse como paso posterior al enlazado en el Makefile del proyecto:
+
+    python3 tools/asset_report.py _build/nrf52840_xxaa.out
+
+Uso: asset_report.py ELF [--sources bitmaps.c ...] [--nm arm-none-eabi-nm]
+"""
+import argparse
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+
+# Simbolos definidos a nivel de fichero: "const uint8_t foto[...] =" o "const bitmap_t x ="
+SYMBOL_RE = re.compile(r"^\s*(?:static\s+)?const\s+\w+\s+(\w+)\s*(?:\[[^\]]*\])?\s*=", re.M)
+
+
+def asset_symbols(sources):
+    names = []
+    for src in sources:
+        names += SYMBOL_RE.findall(Path(src).read_text(encoding="utf-8", errors="replace"))
+    return names
+
+
+def read_symbols(nm, elf):
+    out = subprocess.run([nm, "-S", "--size-sort", elf], check=True,
+                         capture_output=True, text=True).stdout
+    table = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4:
+            _, size, kind, name = parts
+            table[name] = (int(size, 16), kind)
+    return table
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("--sources", nargs="+", default=[str(ROOT / "bitmaps.c")])
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    args = parser.parse_args()
+
+    table = read_symbols(args.nm, args.elf)
+    flash = ram = 0
+    errors = 0
+    print(f"{'Recurso':<24}{'Bytes':>10}  Seccion")
+    for name in asset_symbols(args.sources):
+        if name not in table:
+            print(f"{name:<24}{'-':>10}  (eliminado por el enlazador)")
+            continue
+        size, kind = table[name]
+        in_flash = kind in "Rr"
+        if in_flash:
+            flash += size
+        else:
+            ram += size
+            errors += 1
+        print(f"{name:<24}{size:>10}  {'flash' if in_flash else 'RAM  <-- deberia ser const'}")
+    print(f"{'Total flash':<24}{flash:>10}")
+    print(f"{'Total RAM':<24}{ram:>10}")
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+Convierte imagenes PNG en arrays de C con descriptor bitmap_t (ver bitmaps.h).
+
+Formatos de salida:
+    rgb565      2 bytes por pixel, MSB primero
+    rgb565_rle  rgb565 comprimido con RLE sobre pixeles
+    mono        1 bit por pixel, por filas, MSB a la izquierda
+    mono_rle    mono comprimido con RLE sobre bytes
+
+Formato RLE (el mismo que decodifica LCD_GFX_drawImage): cada paquete empieza con
+un byte de cabecera h. Si h < 128 le siguen h+1 unidades literales; si no, le
+sigue una unidad que se repite (h & 0x7F) + 2 veces. Los paquetes pueden cruzar
+el final de una fila.
+
+Ejemplo:
+    python3 tools/img2c.py logo.png --format rgb565_rle --name logo -o logo.c
+
+El fichero generado se añade a bitmaps.c y se declara en bitmaps.h con
+`extern const bitmap_t logo;`. Requiere Pillow (pip install pillow).
+"""
+import argparse
+import sys
+
+FORMATS = {
+    "rgb565": "BITMAP_FORMAT_RGB565",
+    "rgb565_rle": "BITMAP_FORMAT_RGB565_RLE",
+    "mono": "BITMAP_FORMAT_MONO",
+    "mono_rle": "BITMAP_FORMAT_MONO_RLE",
+}
+
+MAX_LITERAL = 128
+MAX_REPEAT = 129
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def pack_rgb565(pixels):
+    """Lista de colores RGB565 -> unidades de 2 bytes, MSB primero."""
+    return [bytes((c >> 8, c & 0xFF)) for c in pixels]
+
+
+def pack_mono(bits, width, height):
+    """Lista de bits por filas -> unidades de 1 byte, cada fila alineada a byte."""
+    out = []
+    for y in range(height):
+        row = bits[y * width:(y + 1) * width]
+        for i in range(0, width, 8):
+            byte = 0
+            for j, bit in enumerate(row[i:i + 8]):
+                if bit:
+                    byte |= 0x80 >> j
+            out.append(bytes((byte,)))
+    return out
+
+
+def rle_encode(units):
+    """Comprime una lista de unidades (bytes de igual longitud) con el formato RLE."""
+    out = bytearray()
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_LITERAL]
+            del literal[:MAX_LITERAL]
+            out.append(len(chunk) - 1)
+            for u in chunk:
+                out.extend(u)
+
+    i = 0
+    n = len(units)
+    while i < n:
+        run = 1
+        while i + run < n and run < MAX_REPEAT and units[i + run] == units[i]:
+            run += 1
+        # Una repeticion de 2 solo compensa si no parte un literal
+        if run >= 3 or (run == 2 and not literal):
+            flush_literal()
+            out.append(0x80 | (run - 2))
+            out += units[i]
+            i += run
+        else:
+            literal.append(units[i])
+            i += 1
+    flush_literal()
+    return bytes(out)
+
+
+def rle_decode(data, unit, count):
+    """Decodificador de referencia, usado para verificar la salida."""
+    out = []
+    i = 0
+    while len(out) < count:
+        h = data[i]
+        i += 1
+        if h & 0x80:
+            out += [data[i:i + unit]] * ((h & 0x7F) + 2)
+            i += unit
+        else:
+            for _ in range(h + 1):
+                out.append(data[i:i + unit])
+                i += unit
+    return out[:count]
+
+
+def encode(fmt, width, height, pixels=None, bits=None):
+    if fmt.startswith("rgb565"):
+        units = pack_rgb565(pixels)
+    else:
+        units = pack_mono(bits, width, height)
+    if fmt.endswith("_rle"):
+        data = rle_encode(units)
+        assert rle_decode(data, len(units[0]), len(units)) == units
+        return data, len(units) * len(units[0])
+    raw = b"".join(units)
+    return raw, len(raw)
+
+
+def to_c(name, fmt, width, height, data, raw_size, source):
+    lines = [
+        f"// Generado por tools/img2c.py a partir de {source}",
+        f"// {width}x{height}, {fmt}, {len(data)} bytes ({100 * len(data) / raw_size:.1f}% del original)",
+        f"static const uint8_t {name}_data[{len(data)}] = {{",
+    ]
+    for i in range(0, len(data), 16):
+        lines.append("\t" + " ".join(f"0x{b:02x}," for b in data[i:i + 16]))
+    lines += [
+        "};",
+        "",
+        f"const bitmap_t {name} = {{",
+        f"    .width  = {width},",
+        f"    .height = {height},",
+        f"    .format = {FORMATS[fmt]},",
+        f"    .data   = {name}_data,",
+        f"    .size   = sizeof({name}_data)",
+        "};",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convierte imagenes PNG en arrays de C (bitmap_t).")
+    parser.add_argument("png")
+    parser.add_argument("--format", choices=FORMATS, default="rgb565_rle")
+    parser.add_argument("--name", required=True, help="nombre del descriptor bitmap_t")
+    parser.add_argument("--threshold", type=int, default=128,
+                        help="luminancia a partir de la cual un pixel es 1 en los formatos mono")
+    parser.add_argument("--invert", action="store_true", help="invierte los bits en los formatos mono")
+    parser.add_argument("-o", "--output", help="fichero .c de salida (por defecto stdout)")
+    args = parser.parse_args()
+
+    from PIL import Image
+
+    img = Image.open(args.png)
+    width, height = img.size
+    if width > 320 or height > 320:
+        parser.error("la imagen no cabe en la pantalla (maximo 320 pixeles por lado)")
+
+    if args.format.startswith("rgb565"):
+        pixels = [rgb565(*p[:3]) for p in img.convert("RGB").getdata()]
+        data, raw_size = encode(args.format, width, height, pixels=pixels)
+    else:
+        bits = [(p >= args.threshold) != args.invert for p in img.convert("L").getdata()]
+        data, raw_size = encode(args.format, width, height, bits=bits)
+
+    text = to_c(args.name, args.format, width, height, data, raw_size, args.png)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    print(f"{args.name}: {raw_size} -> {len(data)} bytes", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Convierte una grabacion del tactil en una sesion reproducible (XPT2046_session_t).
+
+La grabacion es el log de LCD_TouchScreen_test_record (NRF_LOG por RTT o UART),
+con una linea por entrada:
+
+    R <ms> <pen> <n>        lectura de n muestras, o cambio de PENIRQ si n = 0
+    S <x> <y> <z1> <z2>     cada una de las n muestras de la lectura anterior
+
+Se ignora el resto del log, incluidos los prefijos de NRF_LOG ("<info> app: ").
+Si se ha perdido alguna linea, la lectura incompleta se descarta y se sigue en la
+siguiente linea R. Los tiempos se hacen relativos a la primera entrada.
+
+La sesion generada se enlaza con el firmware y se pasa a
+LCD_TouchScreen_test_replay (o a XPT2046_startReplay). La misma sesion produce
+siempre los mismos eventos y el mismo dibujo, siempre que la calibracion sea la
+misma que al grabar.
+
+Ejemplo:
+    python3 tools/touch_replay.py rtt.log --name touch_session -o touch_session.c
+    python3 tools/touch_replay.py rtt.log --stats
+"""
+import argparse
+import re
+import sys
+
+RECORD_RE = re.compile(r"\bR (\d+) ([01]) (\d+)\s*$")
+SAMPLE_RE = re.compile(r"\bS (\d+) (\d+) (\d+) (\d+)\s*$")
+
+
+def parse(lines):
+    """Devuelve (records, samples, dropped), con dropped las lecturas incompletas descartadas."""
+    records = []
+    samples = []
+    pending = 0
+    dropped = 0
+
+    def drop_pending():
+        # Lectura a la que le faltan muestras: se quita con las que si llegaron
+        first = records.pop()[1]
+        del samples[first:]
+
+    for line in lines:
+        m = RECORD_RE.search(line)
+        if m:
+            if pending:
+                drop_pending()
+                dropped += 1
+            time, pen, n = (int(v) for v in m.groups())
+            records.append((time, len(samples), n, pen))
+            pending = n
+            continue
+        m = SAMPLE_RE.search(line)
+        if m:
+            if not pending:
+                # Muestra de una lectura cuya linea R se perdio (o que sobra): se ignora
+                # hasta la siguiente linea R
+                continue
+            samples.append(tuple(int(v) for v in m.groups()))
+            pending -= 1
+    if pending:
+        # Log cortado a mitad de una lectura
+        drop_pending()
+        dropped += 1
+    if records:
+        t0 = records[0][0]
+        records = [((t - t0) & 0xFFFFFFFF, first, n, pen) for t, first, n, pen in records]
+    return records, samples, dropped
+
+
+def to_c(name, records, samples, source):
+    out = []
+    out.append("// Generado con tools/touch_replay.py a partir de %s" % source)
+    out.append("// %d entradas, %d muestras, %d ms" % (len(records), len(samples), records[-1][0] if records else 0))
+    out.append('#include "XPT2046.h"')
+    out.append("")
+    out.append("static const XPT2046_sample_t %s_samples[] = {" % name)
+    for x, y, z1, z2 in samples:
+        out.append("    {%d, %d, %d, %d}," % (x, y, z1, z2))
+    if not samples:
+        out.append("    {0, 0, 0, 0},")
+    out.append("};")
+    out.append("")
+    out.append("static const XPT2046_record_t %s_records[] = {" % name)
+    for time, first, n, pen in records:
+        out.append("    {%d, %d, %d, %d}," % (time, first, n, pen))
+    out.append("};")
+    out.append("")
+    out.append("const XPT2046_session_t %s = {" % name)
+    out.append("    .records = %s_records," % name)
+    out.append("    .count = %d," % len(records))
+    out.append("    .samples = %s_samples" % name)
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+def stats(records, samples):
+    touches = sum(1 for r in records if r[2] == 0 and r[3] == 1)
+    reads = [r for r in records if r[2] > 0]
+    duration = records[-1][0] if records else 0
+    print("duracion:        %d ms" % duration)
+    print("toques:          %d" % touches)
+    print("lecturas:        %d (%d muestras)" % (len(reads), len(samples)))
+    if len(reads) > 1:
+        gaps = [b[0] - a[0] for a, b in zip(reads, reads[1:]) if b[0] >= a[0]]
+        gaps.sort()
+        print("entre lecturas:  mediana %d ms, max %d ms" % (gaps[len(gaps) // 2], gaps[-1]))
+    size = 12 * len(records) + 8 * len(samples)
+    print("tamaño en flash: %d bytes" % size)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convierte una grabacion del tactil en una sesion XPT2046_session_t.")
+    parser.add_argument("log", help="log de LCD_TouchScreen_test_record ('-' para stdin)")
+    parser.add_argument("--name", default="touch_session", help="nombre de la sesion en C")
+    parser.add_argument("--stats", action="store_true", help="muestra un resumen en lugar de generar C")
+    parser.add_argument("-o", "--output", help="fichero .c de salida (por defecto stdout)")
+    args = parser.parse_args()
+
+    if args.log == "-":
+        lines = sys.stdin.read().splitlines()
+    else:
+        with open(args.log, encoding="utf-8", errors="replace") as f:
+            lines = f.read().splitlines()
+
+    records, samples, dropped = parse(lines)
+    if dropped:
+        print("aviso: %d lecturas incompletas descartadas" % dropped, file=sys.stderr)
+    if not records:
+        parser.error("el log no contiene ninguna entrada")
+
+    if args.stats:
+        stats(records, samples)
+        return
+
+    text = to_c(args.name, records, samples, args.log)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()